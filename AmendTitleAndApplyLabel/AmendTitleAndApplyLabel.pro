@@ -16,18 +16,49 @@ LIBS += $$quote(-LG:/QBITTORRENT/install_mingw/base/lib)
 LIBS += libboost_program_options-mgw92-mt-s-x64-1_72
 LIBS += -lssl -lcrypto -lz -lgdi32 -luser32 -lws2_32 -ladvapi32 -lcrypt32
 
+# Parses the issue, label and mutation responses with simdjson: qmake "CONFIG+=simdjson"
+simdjson {
+    DEFINES += USE_SIMDJSON
+    LIBS += -lsimdjson
+}
+
 HEADERS += postdownloader.h \
+           batchsizer.h \
+           bootstrapquery.h \
+           connectionreader.h \
+           executionplanner.h \
+           graphqlrequest.h \
            issueattributes.h \
            issuegatherer.h \
+           issuesearcher.h \
            issueupdater.h \
+           jsonbackend.h \
            labelcreator.h \
            labelgatherer.h \
-           programoptions.h
+           mutationqueue.h \
+           mutationresult.h \
+           pageinfo.h \
+           programoptions.h \
+           querycost.h \
+           querytemplate.h \
+           regexwords.h \
+           stringescape.h
 
 SOURCES += main.cpp \
+           batchsizer.cpp \
+           bootstrapquery.cpp \
+           executionplanner.cpp \
+           graphqlrequest.cpp \
            issuegatherer.cpp \
+           issuesearcher.cpp \
            issueupdater.cpp \
            labelcreator.cpp \
            labelgatherer.cpp \
+           mutationqueue.cpp \
+           mutationresult.cpp \
+           pageinfo.cpp \
            postdownloader.cpp \
-           programoptions.cpp
+           programoptions.cpp \
+           querycost.cpp \
+           regexwords.cpp \
+           stringescape.cpp
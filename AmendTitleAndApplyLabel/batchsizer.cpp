@@ -0,0 +1,78 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "batchsizer.h"
+
+#include <algorithm>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    // GitHub aborts requests that take more than 10 seconds
+    constexpr auto FAST_LATENCY = 3s;
+    constexpr auto SLOW_LATENCY = 6s;
+    constexpr int GROW_STEP = 2;
+    // Conservative limit for the size of a GraphQL request body
+    constexpr std::size_t MAX_REQUEST_SIZE = 64 * 1024;
+}
+
+BatchSizer::BatchSizer(int initialSize, int maxSize)
+    : m_maxSize(maxSize)
+    , m_size(std::clamp(initialSize, 1, maxSize))
+{
+}
+
+int BatchSizer::size() const
+{
+    return m_size;
+}
+
+std::size_t BatchSizer::maxRequestSize() const
+{
+    return MAX_REQUEST_SIZE;
+}
+
+void BatchSizer::onSuccess(std::chrono::steady_clock::duration latency, int issues)
+{
+    m_busyTime += latency;
+
+    // Only grow if the batch was full, otherwise the latency says nothing about the current size
+    if ((latency < FAST_LATENCY) && (issues >= m_size))
+        m_size = std::min(m_size + GROW_STEP, m_maxSize);
+    else if (latency > SLOW_LATENCY)
+        m_size = std::max((m_size * 3) / 4, 1);
+}
+
+void BatchSizer::onFailure()
+{
+    m_size = std::max(m_size / 2, 1);
+}
+
+double BatchSizer::issuesPerSecond(const int issues) const
+{
+    const double seconds = std::chrono::duration<double>(m_busyTime).count();
+    if (seconds <= 0)
+        return 0;
+
+    return issues / seconds;
+}
@@ -0,0 +1,52 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// Picks how many issues go in each mutation batch.
+// The size grows by a step while batches succeed quickly and is halved when
+// GitHub times out, returns a 502/504 or rejects a batch as too expensive.
+// Slow batches shrink it by a quarter before they turn into timeouts.
+class BatchSizer
+{
+public:
+    explicit BatchSizer(int initialSize, int maxSize);
+
+    int size() const;
+    // Requests larger than this are never built, regardless of size()
+    std::size_t maxRequestSize() const;
+
+    // The issues are the ones sent in the batch, whether or not their mutations succeeded
+    void onSuccess(std::chrono::steady_clock::duration latency, int issues);
+    void onFailure();
+
+    // The rate of the passed issues over the time spent waiting for batches
+    double issuesPerSecond(int issues) const;
+
+private:
+    const int m_maxSize;
+    int m_size;
+    std::chrono::steady_clock::duration m_busyTime{};
+};
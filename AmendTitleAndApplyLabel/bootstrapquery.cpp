@@ -0,0 +1,72 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "bootstrapquery.h"
+
+#include "programoptions.h"
+
+BootstrapQuery::BootstrapQuery(const ProgramOptions &programOptions)
+    : m_variables(json::object())
+{
+    addVariable("$owner: String!", programOptions.repoOwner);
+    addVariable("$name: String!", programOptions.repoName);
+}
+
+void BootstrapQuery::addVariable(std::string_view definition, const json &value)
+{
+    if (!m_definitions.empty())
+        m_definitions += ", ";
+    m_definitions += definition;
+
+    if (value.is_null())
+        return;
+
+    // The name is between the '$' and the ':'
+    const std::string_view name = definition.substr(1, definition.find(':') - 1);
+    m_variables[std::string(name)] = value;
+}
+
+void BootstrapQuery::addRepositoryFields(std::string_view fields)
+{
+    m_repositoryFields += fields;
+    m_repositoryFields += ' ';
+}
+
+void BootstrapQuery::addFields(std::string_view fields)
+{
+    m_fields += fields;
+    m_fields += ' ';
+}
+
+std::string BootstrapQuery::body() const
+{
+    // Sample QraphQL string with the fields of one part
+    // "query($owner: String!, $name: String!) { rateLimit { remaining } repository(owner:$owner, name:$name) { id labels { totalCount } } }"
+    std::string query = "query(" + m_definitions + ") { " + m_fields
+            + "repository(owner:$owner, name:$name) { id " + m_repositoryFields + "} }";
+
+    json req;
+    req["query"] = query;
+    req["variables"] = m_variables;
+
+    return req.dump();
+}
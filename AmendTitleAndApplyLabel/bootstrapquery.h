@@ -0,0 +1,57 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+class ProgramOptions;
+
+// Merges the first requests of a run into one GraphQL query, so that the
+// useful work starts one round-trip after connecting. Every part adds its
+// variables and fields, then parses its own fields from the shared response.
+// The fields of different parts must not conflict, so use aliases when needed.
+class BootstrapQuery
+{
+public:
+    explicit BootstrapQuery(const ProgramOptions &programOptions);
+
+    // `definition` is like "$after: String". A null value leaves the variable unset.
+    void addVariable(std::string_view definition, const json &value = nullptr);
+    // Fields of repository(owner:$owner, name:$name), which always includes the id
+    void addRepositoryFields(std::string_view fields);
+    // Fields of the query root
+    void addFields(std::string_view fields);
+
+    std::string body() const;
+
+private:
+    std::string m_definitions;
+    std::string m_repositoryFields;
+    std::string m_fields;
+    json m_variables;
+};
@@ -0,0 +1,258 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonbackend.h"
+
+using json = nlohmann::json;
+
+// The keys from a node of a connection down to one of its fields, eg {"labels", "nodes", "name"}.
+// Array levels have no key.
+class FieldPath
+{
+public:
+    FieldPath(const std::string *begin, const std::string *end)
+        : m_begin(begin)
+        , m_end(end)
+    {
+    }
+
+    bool is(std::initializer_list<std::string_view> fields) const
+    {
+        return (fields.size() == static_cast<std::size_t>(m_end - m_begin))
+                && std::equal(fields.begin(), fields.end(), m_begin);
+    }
+
+private:
+    const std::string *m_begin;
+    const std::string *m_end;
+};
+
+// The pageInfo of a connection
+struct PageInfo {
+    // Empty if the cursor is null
+    std::string cursor;
+    bool hasNext = false;
+};
+
+// One GraphQL connection read out of a response
+template <typename Node>
+struct Connection {
+    explicit Connection(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+        : nodes(resource)
+    {
+    }
+
+    // A Node with an allocator_type is constructed with the memory resource of the reading
+    std::pmr::vector<Node> nodes;
+    PageInfo pageInfo;
+    // The id of the object that has the connection (eg the repository), if it was requested
+    std::string parentID;
+    // issueCount of a search or totalCount, if it was requested
+    long long count = 0;
+    // False if the connection or one of its parents was null or missing
+    bool isFound = false;
+    bool hasErrors = false;
+};
+
+namespace ConnectionReaderDetail
+{
+    // The SAX handler of parseJson(). It only tracks the keys of the objects it is in,
+    // so no DOM is built and the strings are moved straight into the nodes.
+    // The key slots are kept when their object ends, so the keys reuse their buffers.
+    template <typename Node>
+    class Reader
+    {
+    public:
+        Reader(Connection<Node> &connection, std::vector<std::string_view> &&path,
+               std::string_view cursorField, std::string_view hasNextField)
+            : m_connection(connection)
+            , m_path(std::move(path))
+            , m_cursorField(cursorField)
+            , m_hasNextField(hasNextField)
+        {
+        }
+
+        bool null() { return true; }
+
+        bool boolean(bool value)
+        {
+            if (isPageInfoField(m_hasNextField))
+                m_connection.pageInfo.hasNext = value;
+            return true;
+        }
+
+        bool number_integer(json::number_integer_t value) { return number(value); }
+        bool number_unsigned(json::number_unsigned_t value) { return number(static_cast<long long>(value)); }
+        bool number_float(json::number_float_t, const std::string &) { return true; }
+
+        bool string(std::string &value)
+        {
+            if (m_nodeDepth > 0)
+                m_connection.nodes.back().set(nodeField(), value);
+            else if (isPageInfoField(m_cursorField))
+                m_connection.pageInfo.cursor = std::move(value);
+            else if (isParentID())
+                m_connection.parentID = std::move(value);
+            return true;
+        }
+
+        bool start_object(std::size_t)
+        {
+            if ((m_connectionDepth == 0) && isConnection()) {
+                m_connectionDepth = m_depth + 1;
+                m_connection.isFound = true;
+            }
+            else if ((m_connectionDepth > 0) && (m_nodeDepth == 0) && m_isArray.back()
+                     && (m_depth == m_connectionDepth) && (currentKey() == "nodes")) {
+                m_nodeDepth = m_depth + 1;
+                m_connection.nodes.emplace_back();
+            }
+
+            if (m_keys.size() == m_depth)
+                m_keys.emplace_back();
+            ++m_depth;
+            currentKey().clear();
+            m_isArray.push_back(false);
+            return true;
+        }
+
+        bool key(std::string &value)
+        {
+            if ((m_depth == 1) && (value == "errors"))
+                m_connection.hasErrors = true;
+
+            currentKey().assign(value);
+            return true;
+        }
+
+        bool end_object()
+        {
+            if (m_depth == m_nodeDepth)
+                m_nodeDepth = 0;
+            else if (m_depth == m_connectionDepth)
+                m_connectionDepth = 0;
+
+            --m_depth;
+            m_isArray.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t)
+        {
+            m_isArray.push_back(true);
+            return true;
+        }
+
+        bool end_array()
+        {
+            m_isArray.pop_back();
+            return true;
+        }
+
+    private:
+        bool number(long long value)
+        {
+            if (m_nodeDepth > 0)
+                m_connection.nodes.back().set(nodeField(), value);
+            else if ((m_connectionDepth > 0) && (m_depth == m_connectionDepth) && !m_isArray.back())
+                m_connection.count = value;
+            return true;
+        }
+
+        std::string &currentKey()
+        {
+            return m_keys[m_depth - 1];
+        }
+
+        FieldPath nodeField() const
+        {
+            return FieldPath(m_keys.data() + m_nodeDepth - 1, m_keys.data() + m_depth);
+        }
+
+        // The value of the last key of `m_path`
+        bool isConnection() const
+        {
+            return (m_depth == m_path.size()) && !m_isArray.back()
+                    && std::equal(m_path.begin(), m_path.end(), m_keys.begin());
+        }
+
+        // The id next to the last key of `m_path`
+        bool isParentID() const
+        {
+            return (m_depth == m_path.size()) && !m_isArray.back() && (m_keys[m_depth - 1] == "id")
+                    && std::equal(m_path.begin(), m_path.end() - 1, m_keys.begin());
+        }
+
+        bool isPageInfoField(std::string_view field) const
+        {
+            return (m_connectionDepth > 0) && (m_depth == (m_connectionDepth + 1))
+                    && (m_keys[m_connectionDepth - 1] == "pageInfo") && (m_keys[m_depth - 1] == field);
+        }
+
+        Connection<Node> &m_connection;
+        const std::vector<std::string_view> m_path;
+        const std::string_view m_cursorField;
+        const std::string_view m_hasNextField;
+        // The current key of every object level, the innermost at m_depth - 1
+        std::vector<std::string> m_keys;
+        std::size_t m_depth = 0;
+        std::vector<bool> m_isArray;
+        // The number of object levels inside the connection object and the current node, or 0
+        std::size_t m_connectionDepth = 0;
+        std::size_t m_nodeDepth = 0;
+    };
+}
+
+// Reads the connection at `path` of a GraphQL response (eg {"data", "repository", "issues"})
+// with parseJson(), without building a DOM. Each node gets a Node{} whose
+//   void set(const FieldPath &path, std::string &value)
+//   void set(const FieldPath &path, long long value)
+// are called with every string and integer field below the node. The strings can be moved.
+// `cursorField` and `hasNextField` of pageInfo are like "endCursor" and "hasNextPage".
+// The nodes are allocated from `resource`, eg an arena that is released once they are handled.
+// Throws if the response isn't valid JSON.
+template <typename Node>
+Connection<Node> readConnection(std::string_view response, std::vector<std::string_view> path,
+                                std::string_view cursorField = "endCursor", std::string_view hasNextField = "hasNextPage",
+                                std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+{
+    Connection<Node> connection(resource);
+    ConnectionReaderDetail::Reader<Node> reader(connection, std::move(path), cursorField, hasNextField);
+    std::string error;
+    if (!parseJson(response, reader, error))
+        throw std::runtime_error(error);
+
+    return connection;
+}
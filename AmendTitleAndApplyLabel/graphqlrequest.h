@@ -0,0 +1,48 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+// Builds the HTTP bodies for a GraphQL document that is sent many times.
+// The document text and the variables that never change (eg $owner and $name)
+// are serialized only once. Each request then only serializes its own variables
+// (eg the $after cursor) and appends them.
+class GraphQLRequest
+{
+public:
+    explicit GraphQLRequest(std::string_view document, const json &constantVariables = json::object());
+
+    // `variables` must be a JSON object. It is merged with the constant variables.
+    std::string body(const json &variables = json::object()) const;
+
+private:
+    // Serialized request with the closing braces of `variables` and of the request itself stripped
+    std::string m_head;
+    bool m_hasConstantVariables;
+};
@@ -24,17 +24,22 @@ SOFTWARE. */
 
 #include <string>
 #include <string_view>
-#include <vector>
 
 struct IssueAttributes {
     std::string ID;
+    int number;
+    // The amended title
     std::string title;
-    std::vector<std::string> labelIDs;
+    // The title as gathered, to notice if someone changes it before the update
+    std::string originalTitle;
+    // The label of the matching regex, known once the labels are gathered or created
+    std::string labelID;
 
-    IssueAttributes (std::string_view id, std::string_view t, std::vector<std::string> &&labels)
+    IssueAttributes (std::string_view id, int n, std::string_view t, std::string_view original)
         : ID(id)
+        , number(n)
         , title(t)
-        , labelIDs(labels)
+        , originalTitle(original)
     {
     }
 };
@@ -24,31 +24,102 @@ SOFTWARE. */
 
 #include <iostream>
 
+#include "bootstrapquery.h"
+#include "connectionreader.h"
 #include "issueattributes.h"
+#include "pageinfo.h"
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
+
+namespace
+{
+    // The label is added without replacing the others, so the labels of the issues aren't needed
+    constexpr QueryTemplate ISSUES_FIELDS{"issues(first:100, after:$after, states:OPEN, orderBy:{field:CREATED_AT, direction:DESC}) { "
+                                          "nodes { id number title } pageInfo { endCursor hasNextPage } }"};
+    constexpr auto ISSUES_QUERY = QueryTemplate{"query($owner: String!, $name: String!, $after: String) { "
+                                                "repository(owner:$owner, name:$name) { "} + ISSUES_FIELDS + QueryTemplate{" } }"};
+    static_assert(ISSUES_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate ISSUES_BACKWARD_QUERY{"query($owner: String!, $name: String!, $before: String) { "
+                                                  "repository(owner:$owner, name:$name) { "
+                                                  "issues(last:100, before:$before, states:OPEN, orderBy:{field:CREATED_AT, direction:DESC}) { "
+                                                  "nodes { id number title } pageInfo { startCursor hasPreviousPage } } } }"};
+    static_assert(ISSUES_BACKWARD_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    // The fields of an issue of a page, read by readConnection()
+    struct IssueNode {
+        std::string id;
+        int number = 0;
+        std::string title;
+
+        void set(const FieldPath &path, std::string &value)
+        {
+            if (path.is({"id"}))
+                id = std::move(value);
+            else if (path.is({"title"}))
+                title = std::move(value);
+        }
+
+        void set(const FieldPath &path, long long value)
+        {
+            if (path.is({"number"}))
+                number = static_cast<int>(value);
+        }
+    };
+}
+
+bool PaginationMeeting::claim(const std::string &id)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_claimed.insert(id).second;
+}
 
 IssueGatherer::IssueGatherer(const ProgramOptions &programOptions, PostDownloader &downloader,
                            std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
-                           std::string &error)
+                           std::string &error, Direction direction, PaginationMeeting &meeting)
     : m_programOptions(programOptions)
     , m_downloader(downloader)
     , m_issues(issues)
     , m_error(error)
-    , m_body1part(generateBody1Part())
-    , m_body2part(") { nodes { id title labels(first:100){ nodes { id } } } pageInfo { endCursor hasNextPage } } } }\" }")
+    , m_direction(direction)
+    , m_meeting(meeting)
+    , m_request((direction == Direction::Forward) ? ISSUES_QUERY.text() : ISSUES_BACKWARD_QUERY.text(),
+                {{"owner", programOptions.repoOwner}, {"name", programOptions.repoName}})
 {
     m_error.clear();
 }
 
-void IssueGatherer::run()
+std::string_view IssueGatherer::queryDocument()
 {
+    // Both directions fetch the same fields
+    return ISSUES_QUERY.text();
+}
+
+void IssueGatherer::run(std::string_view firstPage)
+{
+    if (firstPage.empty()) {
+        m_downloader.setRequestBody(pageRequestBody());
+    }
+    else {
+        // The first page came with the bootstrap query
+        gatherIssues(firstPage);
+        if (!m_error.empty() || !prepareNextRequest())
+            return;
+    }
+
     m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueGatherer::onFinishedPage, this));
-    m_downloader.setRequestBody(m_body1part + m_body2part);
     m_downloader.run();
     m_downloader.setFinishedHandler(FinishedHandler{});
 }
 
+void IssueGatherer::addFirstPage(BootstrapQuery &query)
+{
+    // Only the forward direction, the backward one starts along with it
+    query.addVariable("$after: String");
+    query.addRepositoryFields(ISSUES_FIELDS.text());
+}
+
 void IssueGatherer::onFinishedPage()
 {
     if (!m_downloader.error().empty()) {
@@ -61,45 +132,105 @@ void IssueGatherer::onFinishedPage()
         return;
     }
 
-    gatherIssues(m_downloader.response().body());
+    if (m_isDiscarding) {
+        // The gathering stopped while this page was prefetched
+        m_isDiscarding = false;
+    }
+    else {
+        const std::string response = m_downloader.takeResponseBody();
+        const bool isPrefetched = prefetchNextPage(response);
+        gatherIssues(response);
 
-    if (m_error.empty() && m_hasNext) {
-        const std::string body = m_body1part + ", after:\\\"" + m_cursor + "\\\"" + m_body2part;
+        if (isPrefetched) {
+            // An error or meeting the other direction stopped the gathering, so the next page is read and dropped
+            m_isDiscarding = !m_error.empty() || !m_hasNext;
+            return;
+        }
+    }
 
-        m_downloader.setRequestBody(body);
+    if (m_error.empty() && prepareNextRequest())
         m_downloader.sendRequest();
+}
 
-        std::cout << "Downloading next Issues cursor: " << m_cursor << std::endl;
-    }
+// Requests the next page before matching the regexes against this one, so the work overlaps the round-trip.
+// Returns false if the next page is requested only after the parsing.
+bool IssueGatherer::prefetchNextPage(std::string_view response)
+{
+    const std::optional<PageInfo> pageInfo = (m_direction == Direction::Forward)
+            ? scanPageInfo(response, "endCursor", "hasNextPage")
+            : scanPageInfo(response, "startCursor", "hasPreviousPage");
+    if (!pageInfo || !pageInfo->hasNext)
+        return false;
+
+    m_cursor = pageInfo->cursor;
+    m_downloader.setRequestBody(pageRequestBody());
+    m_downloader.sendRequest();
+
+    std::cout << "Downloading " << ((m_direction == Direction::Forward) ? "next" : "previous")
+              << " Issues cursor: " << m_cursor << std::endl;
+    return true;
+}
+
+// Sets the body of the next request. Returns false if the gathering is complete.
+bool IssueGatherer::prepareNextRequest()
+{
+    if (!m_hasNext)
+        return false;
+
+    m_downloader.setRequestBody(pageRequestBody());
+
+    std::cout << "Downloading " << ((m_direction == Direction::Forward) ? "next" : "previous")
+              << " Issues cursor: " << m_cursor << std::endl;
+    return true;
 }
 
 void IssueGatherer::gatherIssues(std::string_view response)
 {
     try {
-        const json data = json::parse(response);
-        if (data.contains("errors")) {
-            m_error = "The last API call returned an error:\n" + data.dump();
+        const bool isForward = (m_direction == Direction::Forward);
+        const Connection<IssueNode> issues = isForward
+                ? readConnection<IssueNode>(response, {"data", "repository", "issues"}, "endCursor", "hasNextPage")
+                : readConnection<IssueNode>(response, {"data", "repository", "issues"}, "startCursor", "hasPreviousPage");
+
+        if (issues.hasErrors) {
+            m_error = "The last API call returned an error:\n" + json::parse(response).dump();
             return;
         }
 
-        const json nodes = data["data"]["repository"]["issues"]["nodes"];
-        for (const auto &node : nodes) {
-            std::string title = node["title"].get<std::string>();
+        if (!issues.isFound) {
+            m_error = "The API response has no issues:\n" + std::string(response);
+            return;
+        }
 
-            for (std::vector<std::regex>::size_type i = 0; i < m_programOptions.regexList.size(); ++i) {
-                if (matchAndAmendTitle(m_programOptions.regexList[i], title)) {
-                    const std::string id = node["id"].get<std::string>();
-                    std::vector<IssueAttributes> &subIssues = m_issues[i];
+        m_hasNext = issues.pageInfo.hasNext;
+        m_cursor = issues.pageInfo.cursor;
 
-                    subIssues.emplace_back(id, title, gatherLabels(node["labels"]["nodes"]));
+        // Both directions walk the issues from their end towards the middle, so that each one
+        // has claimed a contiguous run of issues. The first issue claimed by the other direction
+        // means that all the remaining issues are already gathered.
+        const auto claim = [this](const IssueNode &node) -> bool
+        {
+            if (!m_meeting.claim(node.id)) {
+                m_hasNext = false;
+                return false;
+            }
+
+            matchIssue(m_programOptions, m_issues, node.id, node.number, node.title);
+            return true;
+        };
+
+        if (isForward) {
+            for (auto iter = issues.nodes.cbegin(); iter != issues.nodes.cend(); ++iter) {
+                if (!claim(*iter))
+                    break;
+            }
+        }
+        else {
+            for (auto iter = issues.nodes.crbegin(); iter != issues.nodes.crend(); ++iter) {
+                if (!claim(*iter))
                     break;
-                }
             }
         }
-
-        const json pageinfo = data["data"]["repository"]["issues"]["pageInfo"];
-        m_hasNext = pageinfo["hasNextPage"].get<bool>();
-        m_cursor = pageinfo["endCursor"].get<std::string>();
     }
     catch (const std::exception &e) {
         m_error += "Exception: ";
@@ -107,57 +238,36 @@ void IssueGatherer::gatherIssues(std::string_view response)
     }
 }
 
-bool IssueGatherer::matchAndAmendTitle(const std::regex &regex, std::string &title)
+void IssueGatherer::matchIssue(const ProgramOptions &programOptions,
+                               std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
+                               std::string_view id, const int number, const std::string &title)
 {
-    if (!std::regex_search(title, regex))
-        return false;
-
-    title = std::regex_replace(title, regex, "");
-
-    // We need to escape special characters(eg double quotes) for GraphQL
-    // Strings literals need 2 levels of escape
-    // Example title: Test "x"
-    // Correctly escaped, it should look like this
-    // when the GraphQL query string is printed: Test \\\"x\\\"
-    std::string buffer;
-    buffer.reserve(title.size() + 2); // reserve 2 extra characters. Usually there shouldn't be more than one pair of doublequotes
-    for (auto ch : title) {
-        switch (ch) {
-        case '\"':
-            buffer.append("\\\"");
-            break;
-        case '\\':
-            buffer.append("\\\\");
-            break;
-        case '/':
-            buffer.append("\\/");
-            break;
-        default:
-            buffer.append(1, ch);
+    for (std::vector<std::regex>::size_type i = 0; i < programOptions.regexList.size(); ++i) {
+        std::string amendedTitle = title;
+        if (matchAndAmendTitle(programOptions.regexList[i], amendedTitle)) {
+            issues[i].emplace_back(id, number, amendedTitle, title);
             break;
         }
     }
+}
 
-    title.swap(buffer);
+std::string IssueGatherer::pageRequestBody() const
+{
+    json variables = json::object();
+    if (!m_cursor.empty())
+        variables[(m_direction == Direction::Forward) ? "after" : "before"] = m_cursor;
 
-    return true;
+    return m_request.body(variables);
 }
 
-std::vector<std::string> IssueGatherer::gatherLabels (const json &LabelsNodes)
+bool IssueGatherer::matchAndAmendTitle(const std::regex &regex, std::string &title)
 {
-    std::vector<std::string> labels;
+    if (!std::regex_search(title, regex))
+        return false;
 
-    for (const auto &node : LabelsNodes)
-        labels.emplace_back(node["id"].get<std::string>());
+    // The title is escaped when it is written into the mutation
+    title = std::regex_replace(title, regex, "");
 
-    return labels;
+    return true;
 }
 
-std::string IssueGatherer::generateBody1Part()
-{
-    return "{\"query\": \"query { repository(owner:\\\"" +
-            m_programOptions.repoOwner +
-            "\\\", name:\\\"" +
-            m_programOptions.repoName +
-            "\\\") { issues(first:100, states:OPEN, orderBy:{field:CREATED_AT, direction:DESC}";
-}
@@ -22,36 +22,72 @@ SOFTWARE. */
 
 #pragma once
 
+#include <mutex>
 #include <regex>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "graphqlrequest.h"
+
 using json = nlohmann::json;
 
+class BootstrapQuery;
 struct IssueAttributes;
 class ProgramOptions;
 class PostDownloader;
 
+// Shared by two IssueGatherers that paginate the same connection from both ends.
+// Every issue is claimed by the first gatherer that sees it. When a gatherer
+// finds an issue already claimed by the other one, the two have met.
+class PaginationMeeting
+{
+public:
+    // Returns false if the issue was already claimed
+    bool claim(const std::string &id);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_set<std::string> m_claimed;
+};
+
 class IssueGatherer
 {
 public:
+    enum class Direction
+    {
+        Forward,  // first/after from the newest issue
+        Backward  // last/before from the oldest issue
+    };
+
     // The passed arguments must outlive the class instance
     explicit IssueGatherer(const ProgramOptions &programOptions, PostDownloader &downloader,
                            std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
-                           std::string &error);
+                           std::string &error, Direction direction, PaginationMeeting &meeting);
 
-    void run();
+    // The first page may come from the response of the bootstrap query
+    void run(std::string_view firstPage = {});
+
+    // The GraphQL document of each page, used to estimate its cost
+    static std::string_view queryDocument();
+    // Adds the request of the first forward page to the bootstrap query
+    static void addFirstPage(BootstrapQuery &query);
+    // Adds the issue to the issues of the first regex that matches its title, with the match removed from the title
+    static void matchIssue(const ProgramOptions &programOptions,
+                           std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
+                           std::string_view id, const int number, const std::string &title);
 
 private:
     void onFinishedPage();
+    bool prepareNextRequest();
+    bool prefetchNextPage(std::string_view response);
 
-    bool matchAndAmendTitle(const std::regex &regex, std::string &title);
-    std::vector<std::string> gatherLabels (const json &LabelsNodes);
+    static bool matchAndAmendTitle(const std::regex &regex, std::string &title);
     void gatherIssues(std::string_view response);
-    std::string generateBody1Part();
+    std::string pageRequestBody() const;
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
@@ -59,8 +95,11 @@ private:
     std::string &m_error;
 
 
-    const std::string m_body1part;
-    const std::string m_body2part;
+    const Direction m_direction;
+    PaginationMeeting &m_meeting;
+    const GraphQLRequest m_request;
     std::string m_cursor;
     bool m_hasNext = false;
+    // A prefetched page arrives after the gathering stopped
+    bool m_isDiscarding = false;
 };
@@ -0,0 +1,200 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "issuesearcher.h"
+
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+#include "connectionreader.h"
+#include "issueattributes.h"
+#include "issuegatherer.h"
+#include "postdownloader.h"
+#include "programoptions.h"
+#include "querytemplate.h"
+#include "regexwords.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    constexpr QueryTemplate SEARCH_QUERY{"query($query: String!, $after: String) { "
+                                         "search(query:$query, type:ISSUE, first:100, after:$after) { "
+                                         "issueCount nodes { ... on Issue { id number title } } pageInfo { endCursor hasNextPage } } }"};
+    static_assert(SEARCH_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    // The search API returns at most this many results for a query
+    constexpr int SEARCH_RESULTS_LIMIT = 1000;
+
+    // The fields of an issue of a page, read by readConnection()
+    struct IssueNode {
+        std::string id;
+        int number = 0;
+        std::string title;
+
+        void set(const FieldPath &path, std::string &value)
+        {
+            if (path.is({"id"}))
+                id = std::move(value);
+            else if (path.is({"title"}))
+                title = std::move(value);
+        }
+
+        void set(const FieldPath &path, long long value)
+        {
+            if (path.is({"number"}))
+                number = static_cast<int>(value);
+        }
+    };
+}
+
+IssueSearcher::IssueSearcher(const ProgramOptions &programOptions, PostDownloader &downloader,
+                             std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
+                             std::string &error)
+    : m_programOptions(programOptions)
+    , m_downloader(downloader)
+    , m_issues(issues)
+    , m_error(error)
+    , m_request(SEARCH_QUERY.text())
+    , m_queries(searchQueries(programOptions))
+{
+    m_error.clear();
+}
+
+void IssueSearcher::run()
+{
+    if (m_queries.empty()) {
+        m_isComplete = false;
+        return;
+    }
+
+    m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueSearcher::onFinishedPage, this));
+    m_downloader.setRequestBody(pageRequestBody());
+    m_downloader.run();
+    m_downloader.setFinishedHandler(FinishedHandler{});
+}
+
+bool IssueSearcher::isComplete() const
+{
+    return m_isComplete;
+}
+
+std::vector<std::string> IssueSearcher::searchQueries(const ProgramOptions &programOptions)
+{
+    const std::string repo = "repo:" + programOptions.repoOwner + "/" + programOptions.repoName + " is:issue is:open in:title";
+    std::vector<std::string> queries;
+
+    for (const std::string &pattern : programOptions.regexPatterns) {
+        const std::vector<std::string> words = requiredWords(pattern);
+        if (words.empty())
+            return {};
+
+        std::string query = repo;
+        for (const std::string &word : words)
+            query += " \"" + word + "\"";
+        queries.push_back(query);
+    }
+
+    return queries;
+}
+
+void IssueSearcher::onFinishedPage()
+{
+    if (!m_downloader.error().empty()) {
+        m_error = m_downloader.error();
+        return;
+    }
+
+    if (m_downloader.response().base().result() != http::status::ok) {
+        m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
+        return;
+    }
+
+    gatherIssues(m_downloader.response().body());
+
+    if (!m_error.empty() || !m_isComplete)
+        return;
+
+    if (!m_hasNext) {
+        if (++m_queryPos == m_queries.size())
+            return;
+
+        m_cursor.clear();
+    }
+
+    m_downloader.setRequestBody(pageRequestBody());
+    m_downloader.sendRequest();
+
+    if (m_hasNext)
+        std::cout << "Downloading next search results cursor: " << m_cursor << std::endl;
+}
+
+void IssueSearcher::gatherIssues(std::string_view response)
+{
+    try {
+        const Connection<IssueNode> search = readConnection<IssueNode>(response, {"data", "search"});
+        if (search.hasErrors) {
+            m_error = "The last API call returned an error:\n" + json::parse(response).dump();
+            return;
+        }
+
+        if (!search.isFound) {
+            m_error = "The API response has no search results:\n" + std::string(response);
+            return;
+        }
+
+        if (m_cursor.empty()) {
+            std::cout << "The search '" << m_queries[m_queryPos] << "' matched " << search.count << " issues" << std::endl;
+
+            if (search.count > SEARCH_RESULTS_LIMIT) {
+                m_isComplete = false;
+                return;
+            }
+        }
+
+        for (const IssueNode &node : search.nodes) {
+            // Pull requests have no fields in the Issue fragment
+            if (node.id.empty())
+                continue;
+
+            if (m_candidates.insert(node.id).second)
+                IssueGatherer::matchIssue(m_programOptions, m_issues, node.id, node.number, node.title);
+        }
+
+        m_hasNext = search.pageInfo.hasNext;
+        m_cursor = search.pageInfo.cursor;
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+std::string IssueSearcher::pageRequestBody() const
+{
+    json variables = {{"query", m_queries[m_queryPos]}};
+    if (!m_cursor.empty())
+        variables["after"] = m_cursor;
+
+    return m_request.body(variables);
+}
@@ -0,0 +1,74 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "graphqlrequest.h"
+
+struct IssueAttributes;
+class ProgramOptions;
+class PostDownloader;
+
+// Finds the candidate issues of each regex with the search API, from the whole words
+// that every title it matches must contain. The regexes then run only on the candidates,
+// instead of on every open issue. An issue found by more than one search is matched once.
+class IssueSearcher
+{
+public:
+    // The passed arguments must outlive the class instance
+    explicit IssueSearcher(const ProgramOptions &programOptions, PostDownloader &downloader,
+                           std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
+                           std::string &error);
+
+    void run();
+    // False if a search matched more issues than the search API returns.
+    // Then all the open issues must be scanned instead.
+    bool isComplete() const;
+
+    // One search per regex. Empty if some regex doesn't require any whole word.
+    static std::vector<std::string> searchQueries(const ProgramOptions &programOptions);
+
+private:
+    void onFinishedPage();
+
+    void gatherIssues(std::string_view response);
+    std::string pageRequestBody() const;
+
+    const ProgramOptions &m_programOptions;
+    PostDownloader &m_downloader;
+    std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &m_issues;
+    std::string &m_error;
+
+    const GraphQLRequest m_request;
+    const std::vector<std::string> m_queries;
+    std::vector<std::string>::size_type m_queryPos = 0;
+    std::unordered_set<std::string> m_candidates;
+    std::string m_cursor;
+    bool m_hasNext = false;
+    bool m_isComplete = true;
+};
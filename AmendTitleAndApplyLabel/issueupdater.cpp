@@ -22,29 +22,106 @@ SOFTWARE. */
 
 #include "issueupdater.h"
 
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <string_view>
+#include <unordered_map>
 
 #include <nlohmann/json.hpp>
 
 #include "issueattributes.h"
+#include "mutationresult.h"
 #include "postdownloader.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
 namespace
 {
-    constexpr int BATCH_SIZE = 10;
+    constexpr int INITIAL_BATCH_SIZE = 10;
+    constexpr int MAX_BATCH_SIZE = 50;
+    // Consecutive failures of a whole batch
+    constexpr int MAX_RETRIES = 5;
+    // Attempts of an issue whose alias keeps failing
+    constexpr int MAX_ISSUE_ATTEMPTS = 3;
+
+    // The steps of each issue in the MutationQueue
+    constexpr MutationQueue::Steps TITLE_STEP = 1;
+    constexpr MutationQueue::Steps LABEL_STEP = 2;
+    // Setting the amended title or adding the label twice leaves the issue as once
+    constexpr MutationQueue::Steps REPEATABLE_STEPS = TITLE_STEP | LABEL_STEP;
+
+    // updateIssue would replace all the labels, so the label is added with its own mutation
+    constexpr QueryTemplate TITLE_ALIAS{"title%n: updateIssue(input: {id:\"%s\", title:\"%q\"}) { clientMutationId } "};
+    constexpr QueryTemplate LABEL_ALIAS{"label%n: addLabelsToLabelable(input: {labelableId:\"%s\", labelIds:[\"%s\"]}) { clientMutationId } "};
+
+    // The upcoming issues are revalidated right before they are updated, as many as nodes(ids:) accepts at once
+    constexpr QueryTemplate REVALIDATION_QUERY{"query($ids: [ID!]!) { nodes(ids:$ids) { ... on Issue { id state title } } }"};
+    static_assert(REVALIDATION_QUERY.isBalanced(), "Unbalanced GraphQL query");
+    constexpr std::size_t REVALIDATION_WINDOW = 100;
+
+    // What the errors of a response without data say about the batch
+    enum class BatchFailure
+    {
+        Other,
+        // The query ran out of time and may have been applied in part
+        Timeout,
+        // The query was rejected before it ran
+        TooExpensive
+    };
+
+    // GitHub gives a timeout no type, only this message
+    constexpr std::string_view TIMEOUT_MESSAGE = "Something went wrong while executing your query. This may be the result of a timeout";
+    constexpr std::string_view COMPLEXITY_MESSAGE = "Query has complexity of ";
+
+    BatchFailure classifyErrors(const json &errors)
+    {
+        if (!errors.is_array())
+            return BatchFailure::Other;
+
+        for (const auto &error : errors) {
+            if (!error.is_object())
+                continue;
+
+            const auto typeIt = error.find("type");
+            const auto messageIt = error.find("message");
+            const std::string_view type = ((typeIt != error.end()) && typeIt->is_string())
+                    ? std::string_view(typeIt->get_ref<const std::string &>()) : std::string_view{};
+            const std::string_view message = ((messageIt != error.end()) && messageIt->is_string())
+                    ? std::string_view(messageIt->get_ref<const std::string &>()) : std::string_view{};
+
+            if (message.substr(0, TIMEOUT_MESSAGE.size()) == TIMEOUT_MESSAGE)
+                return BatchFailure::Timeout;
+
+            if ((type == "MAX_NODE_LIMIT_EXCEEDED") || (type == "RESOURCE_LIMITS_EXCEEDED")
+                    || (message.substr(0, COMPLEXITY_MESSAGE.size()) == COMPLEXITY_MESSAGE))
+                return BatchFailure::TooExpensive;
+        }
+
+        return BatchFailure::Other;
+    }
+
+    std::vector<const IssueAttributes *> flattenIssues(const std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues)
+    {
+        std::vector<const IssueAttributes *> flat;
+        for (const auto &pair : issues) {
+            for (const IssueAttributes &attr : pair.second)
+                flat.push_back(&attr);
+        }
+
+        return flat;
+    }
 }
 
 IssueUpdater::IssueUpdater(PostDownloader &downloader,
                            const std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
                            std::string &error)
     : m_downloader(downloader)
-    , m_issues(issues)
+    , m_issues(flattenIssues(issues))
     , m_error(error)
-    , m_regexPos(issues.cbegin())
-    , m_hasNextBatch(m_issues.size() > 0)
+    , m_batchSizer(INITIAL_BATCH_SIZE, MAX_BATCH_SIZE)
+    , m_queue(m_issues.size(), TITLE_STEP | LABEL_STEP, MAX_ISSUE_ATTEMPTS)
+    , m_revalidationRequest(REVALIDATION_QUERY.text())
 {
     m_error.clear();
 }
@@ -55,118 +132,319 @@ void IssueUpdater::run()
         return;
 
     m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueUpdater::onFinishedPage, this));
+    sendBatch(false);
+    m_downloader.runSent();
+    m_downloader.setFinishedHandler(FinishedHandler{});
 
-    json req;
-    req["query"] = nextBatch();
-    m_downloader.setRequestBody(req.dump());
+    // Only an error stops the run early, so the issues left mean one went unreported
+    if (m_error.empty() && (hasNextBatch() || (m_queue.batchSize() > 0)))
+        m_error = "The update stopped before all the issues were processed: " + std::string(m_downloader.error());
 
-    m_downloader.run();
-    m_downloader.setFinishedHandler(FinishedHandler{});
+    if (!m_error.empty())
+        return;
+
+    if (m_staleIssues > 0)
+        std::cout << "Skipped " << m_staleIssues << " issues that were closed or retitled since they were gathered" << std::endl;
+
+    std::cout << "Updated " << m_updatedIssues << " issues at "
+              << m_batchSizer.issuesPerSecond(m_updatedIssues) << " issues/s. The final batch size was "
+              << m_batchSizer.size() << " issues" << std::endl;
+
+    if (!m_failedIssues.empty()) {
+        m_error = "Failed to update " + std::to_string(m_failedIssues.size()) + " issues:";
+        for (const std::string &id : m_failedIssues)
+            m_error += " " + id;
+    }
 }
 
 void IssueUpdater::onFinishedPage()
 {
+    if (m_isRevalidating) {
+        onRevalidated();
+        return;
+    }
+
+    const auto latency = std::chrono::steady_clock::now() - m_batchSentTime;
+
     if (!m_downloader.error().empty()) {
-        m_error = m_downloader.error();
+        // Most likely a timeout. The connection can't be used anymore.
+        if (rewindUnansweredBatch(m_downloader.error()))
+            sendBatch(true);
+        return;
+    }
+
+    const http::status status = m_downloader.response().base().result();
+    if ((status == http::status::bad_gateway) || (status == http::status::gateway_timeout)) {
+        if (rewindUnansweredBatch("HTTP status code " + std::to_string(m_downloader.response().base().result_int())))
+            sendBatch(!m_downloader.isKeptAlive());
         return;
     }
 
-    if (m_downloader.response().base().result() != http::status::ok) {
+    if (status != http::status::ok) {
         m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
         return;
     }
 
-    gatherIssues(m_downloader.response().body());
+    const int batchIssues = m_queue.batchSize();
+    if (!gatherIssues(m_downloader.response().body())) {
+        if (m_error.empty())
+            sendBatch(false);
+        return;
+    }
+
+    m_retries = 0;
+    m_batchSizer.onSuccess(latency, batchIssues);
 
-    if (!m_error.empty() || !hasNextBatch())
+    if (!hasNextBatch())
         return;
 
+    sendBatch(false);
+}
+
+void IssueUpdater::sendBatch(const bool onNewConnection)
+{
+    if (needsRevalidation()) {
+        sendRevalidation(onNewConnection);
+        return;
+    }
+
+    // Only retries waiting for their backoff may be left
+    const auto wait = m_queue.waitTime(std::chrono::steady_clock::now());
+    m_batchSentTime = std::chrono::steady_clock::now() + wait;
+
     json req;
-    req["query"] = nextBatch();
+    req["query"] = nextBatch(m_batchSentTime);
     m_downloader.setRequestBody(req.dump());
-    m_downloader.sendRequest();
+
+    if (onNewConnection)
+        m_downloader.resendOnNewConnection();
+    else if (wait > std::chrono::steady_clock::duration::zero())
+        m_downloader.sendRequestAfter(wait);
+    else
+        m_downloader.sendRequest();
+}
+
+// True if the next batch might take issues that weren't revalidated
+bool IssueUpdater::needsRevalidation() const
+{
+    return (m_revalidatedEnd < m_issues.size())
+            && ((m_queue.nextIssue() + static_cast<std::size_t>(m_batchSizer.size())) > m_revalidatedEnd);
 }
 
-void IssueUpdater::gatherIssues(std::string_view response)
+void IssueUpdater::sendRevalidation(const bool onNewConnection)
+{
+    m_revalidatedBegin = std::max(m_revalidatedEnd, m_queue.nextIssue());
+    m_revalidatedEnd = std::min(m_revalidatedBegin + REVALIDATION_WINDOW, m_issues.size());
+
+    json ids = json::array();
+    for (std::size_t i = m_revalidatedBegin; i < m_revalidatedEnd; ++i)
+        ids.push_back(m_issues[i]->ID);
+
+    m_isRevalidating = true;
+    m_downloader.setRequestBody(m_revalidationRequest.body({{"ids", ids}}));
+
+    if (onNewConnection)
+        m_downloader.resendOnNewConnection();
+    else
+        m_downloader.sendRequest();
+}
+
+void IssueUpdater::onRevalidated()
+{
+    m_isRevalidating = false;
+
+    // The revalidation only saves mutations, so if it fails the issues are updated as gathered
+    const bool isBroken = !m_downloader.error().empty();
+    if (isBroken || (m_downloader.response().base().result() != http::status::ok)
+            || !revalidateIssues(m_downloader.response().body()))
+        std::cout << "Failed to revalidate the next issues, updating them as gathered" << std::endl;
+
+    if (hasNextBatch())
+        sendBatch(isBroken || !m_downloader.isKeptAlive());
+}
+
+// Skips the issues that were deleted, closed or retitled since they were gathered.
+// A retitled issue might not match the regex anymore and its amended title would overwrite the new one.
+// Returns false if the response can't be used.
+bool IssueUpdater::revalidateIssues(std::string_view response)
 {
     try {
         const json data = json::parse(response);
-        if (data.contains("errors")) {
-            m_error = "The last API call returned an error:\n" + data.dump();
-            return;
+        // A deleted issue is reported as an error along with the data
+        if (!data.contains("data") || data["data"].is_null())
+            return false;
+
+        const json &nodes = data["data"]["nodes"];
+        if (nodes.size() != (m_revalidatedEnd - m_revalidatedBegin))
+            return false;
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const json &node = nodes[i];
+            const std::size_t issue = m_revalidatedBegin + i;
+            const bool isStale = node.is_null()
+                    || (node.value("state", std::string{}) != "OPEN")
+                    || (node.value("title", std::string{}) != m_issues[issue]->originalTitle);
+
+            if (isStale) {
+                m_queue.skipIssue(issue);
+                ++m_staleIssues;
+            }
         }
+    }
+    catch (const std::exception &) {
+        return false;
+    }
+
+    return true;
+}
 
-        const json issues = data["data"];
-        std::cout << "Updated " << issues.size() << " issues" << std::endl;
+// The batch got no result, so GitHub may have applied some of it. It is sent again only if
+// that does no harm. Otherwise the run stops, as the issues of the batch are in an unknown state.
+bool IssueUpdater::rewindUnansweredBatch(std::string_view reason)
+{
+    if (m_queue.batchSteps() & ~REPEATABLE_STEPS) {
+        m_error = "The batch failed (" + std::string(reason) + ") and may have been applied, so it can't be sent again";
+        return false;
+    }
+
+    return rewindBatch(reason);
+}
+
+// Puts the issues of the last batch back and shrinks the batch size
+bool IssueUpdater::rewindBatch(std::string_view reason)
+{
+    if (m_retries == MAX_RETRIES) {
+        m_error = "The batch failed " + std::to_string(MAX_RETRIES + 1) + " times. Last failure: " + std::string(reason);
+        return false;
+    }
+
+    ++m_retries;
+    m_batchSizer.onFailure();
+    m_queue.rewindBatch();
+
+    std::cout << "The batch failed (" << reason << "). Retrying with "
+              << m_batchSizer.size() << " issues per batch" << std::endl;
+    return true;
+}
+
+// Returns false if the batch was rewound to be retried or m_error is set
+bool IssueUpdater::gatherIssues(std::string_view response)
+{
+    try {
+        const MutationResult mutationResult = readMutationResult(response);
+
+        // Each error points to the alias that failed with its path
+        std::unordered_map<std::string, std::string> aliasErrors;
+        if (mutationResult.hasErrors) {
+            // The errors are rare, so only then the whole response is parsed
+            const json data = json::parse(response);
+            if (!mutationResult.hasData) {
+                // GitHub answers with errors and no data when a query times out or costs too much.
+                // A query that costs too much is rejected before it runs, but a timed out one may have been applied in part.
+                const BatchFailure failure = classifyErrors(data["errors"]);
+                if (failure == BatchFailure::Timeout) {
+                    rewindUnansweredBatch("the query timed out");
+                    return false;
+                }
+
+                if (failure == BatchFailure::TooExpensive) {
+                    rewindBatch("the query was too expensive");
+                    return false;
+                }
+
+                m_error = "The last API call returned an error:\n" + data.dump();
+                return false;
+            }
+
+            for (const auto &error : data["errors"]) {
+                if (error.contains("path") && !error["path"].empty())
+                    aliasErrors[error["path"][0].get<std::string>()] = error.value("message", "");
+            }
+        }
+
+        const auto succeeded = [&mutationResult](const std::string &alias)
+        {
+            return mutationResult.succeededAliases.count(alias) > 0;
+        };
+        const MutationQueue::BatchResult result = m_queue.finishBatch(succeeded, std::chrono::steady_clock::now());
+
+        m_updatedIssues += result.completedIssues;
+        std::cout << "Updated " << result.completedIssues << " issues" << std::endl;
+
+        for (const std::string &alias : result.failedAliases)
+            std::cout << "The alias " << alias << " failed and will be retried: " << aliasErrors[alias] << std::endl;
+
+        for (const std::size_t issue : result.abandonedIssues)
+            m_failedIssues.push_back(m_issues[issue]->ID);
     }
     catch (const std::exception &e) {
         m_error += "Exception: ";
         m_error += e.what();
+        return false;
     }
+
+    return true;
 }
 
-std::string IssueUpdater::nextBatch()
+std::string IssueUpdater::nextBatch(MutationQueue::TimePoint sendTime)
 {
     if (!hasNextBatch())
         return {};
 
-    // Sample QraphQL string for the mutation with one alias named 'issue0'
-    // "mutation UpdateIssue { issue0: updateIssue(input: {id:\\\"ISSUE-ID\\\", title:\\\"TITLE\\\", labelIds:[\\\"ID0\\\", \\\"ID1\\\"]}) { clientMutationId } }"
-    const std::string start = "mutation UpdateIssue { ";
-    const std::string end = " }";
-
-    int counter = 0;
-    std::ostringstream buffer;
-    buffer << start;
-    for (; ((m_regexPos != m_issues.cend()) && (counter < BATCH_SIZE)); ++m_regexPos) {
-        const auto &subIssues = m_regexPos->second;
-
-        for (; ((m_issuePos < subIssues.size()) && (counter < BATCH_SIZE)); ++m_issuePos) {
-            const auto &attr = subIssues[m_issuePos];
-            buffer << makeIssueAlias(counter, attr);
-            ++counter;
-        }
+    // Sample QraphQL string for the mutation of one issue
+    // "mutation UpdateIssue { title0: updateIssue(input: {id:\"ISSUE-ID\", title:\"TITLE\"}) { clientMutationId } "
+    // "label0: addLabelsToLabelable(input: {labelableId:\"ISSUE-ID\", labelIds:[\"LABEL-ID\"]}) { clientMutationId } }"
+    const std::string_view start = "mutation UpdateIssue { ";
+    const std::string_view end = " }";
+
+    std::string buffer;
+    buffer.reserve(4096);
+    buffer.append(start);
+    while ((m_queue.batchSize() < m_batchSizer.size()) && ((buffer.size() + end.size()) <= m_batchSizer.maxRequestSize())) {
+        // The issues past the revalidated ones wait for the next batch
+        if ((m_queue.nextIssue() >= m_revalidatedEnd) && (m_revalidatedEnd < m_issues.size()))
+            break;
 
-        if (m_issuePos < subIssues.size())
+        const MutationQueue::Item *item = m_queue.takeReady(sendTime);
+        if (!item)
             break;
-        else
-            m_issuePos = 0;
-    }
 
-    if ((m_regexPos == m_issues.cend()))
-        m_hasNextBatch = false;
+        // The alias counter is the position in the batch
+        const int counter = m_queue.batchSize() - 1;
+        writeIssueAliases(buffer, counter, *item);
+    }
 
-    buffer << end;
-    return buffer.str();
+    buffer.append(end);
+    return buffer;
 }
 
 bool IssueUpdater::hasNextBatch()
 {
-    return m_hasNextBatch;
+    return !m_queue.empty();
 }
-
-std::string IssueUpdater::makeIssueAlias(const int counter, const IssueAttributes &attr)
+int IssueUpdater::initialBatchSize()
 {
-    const std::string part1 = ": updateIssue(input: {id:\"";
-    const std::string part2 = "\", title:\"";
-    const std::string part3 = "\", labelIds:[";
-    const std::string part4 = "]}) { clientMutationId } ";
-
-    std::ostringstream buffer;
-    buffer << "issue" << counter << part1 << attr.ID << part2 << attr.title << part3 << makeLabelArray(attr.labelIDs) << part4;
+    return INITIAL_BATCH_SIZE;
+}
 
-    return buffer.str();
+int IssueUpdater::mutationsPerIssue()
+{
+    // The title is amended and the label is added
+    return 2;
 }
 
-std::string IssueUpdater::makeLabelArray(const std::vector<std::string> &labelIDs)
+void IssueUpdater::writeIssueAliases(std::string &buffer, const int counter, const MutationQueue::Item &item)
 {
-    if (labelIDs.empty())
-        return {};
+    const IssueAttributes &issue = *m_issues[item.issue];
 
-    std::ostringstream buffer;
-    for (auto i = labelIDs.cbegin(); i != --labelIDs.cend(); ++i)
-        buffer << "\"" << *i << "\"" << ", ";
-    buffer << "\"" << labelIDs.back() << "\"";
+    // Only the steps that haven't succeeded yet are retried
+    if (item.steps & TITLE_STEP) {
+        writeQuery<TITLE_ALIAS>(buffer, counter, issue.ID, issue.title);
+        m_queue.addAlias("title" + std::to_string(counter), TITLE_STEP);
+    }
 
-    return buffer.str();
+    if (item.steps & LABEL_STEP) {
+        writeQuery<LABEL_ALIAS>(buffer, counter, issue.ID, issue.labelID);
+        m_queue.addAlias("label" + std::to_string(counter), LABEL_STEP);
+    }
 }
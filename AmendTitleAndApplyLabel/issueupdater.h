@@ -22,10 +22,19 @@ SOFTWARE. */
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include <nlohmann/json.hpp>
+
+#include "batchsizer.h"
+#include "graphqlrequest.h"
+#include "mutationqueue.h"
+
+using json = nlohmann::json;
+
 struct IssueAttributes;
 class PostDownloader;
 
@@ -38,20 +47,42 @@ public:
                           std::string &error);
 
     void run();
-    std::string nextBatch();
+    std::string nextBatch(MutationQueue::TimePoint sendTime);
     bool hasNextBatch();
 
+    // Used to estimate the cost of the batches
+    static int initialBatchSize();
+    static int mutationsPerIssue();
+
 private:
     void onFinishedPage();
 
-    void gatherIssues(std::string_view response);
-    std::string makeIssueAlias(const int counter, const IssueAttributes &attr);
-    std::string makeLabelArray(const std::vector<std::string> &labelIDs);
+    void sendBatch(const bool onNewConnection);
+    bool needsRevalidation() const;
+    void sendRevalidation(const bool onNewConnection);
+    void onRevalidated();
+    bool revalidateIssues(std::string_view response);
+    bool rewindUnansweredBatch(std::string_view reason);
+    bool rewindBatch(std::string_view reason);
+    bool gatherIssues(std::string_view response);
+    void writeIssueAliases(std::string &buffer, const int counter, const MutationQueue::Item &item);
 
     PostDownloader &m_downloader;
-    const std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &m_issues;
+    // The issues of all the regexes in the order they are updated
+    std::vector<const IssueAttributes *> m_issues;
     std::string &m_error;
-    std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>>::const_iterator m_regexPos;
-    int m_issuePos = 0;
-    bool m_hasNextBatch;
+    BatchSizer m_batchSizer;
+    MutationQueue m_queue;
+    std::chrono::steady_clock::time_point m_batchSentTime;
+    std::vector<std::string> m_failedIssues;
+    int m_retries = 0;
+    // Issues whose mutations all succeeded
+    int m_updatedIssues = 0;
+
+    // Issues [m_revalidatedBegin, m_revalidatedEnd) were revalidated last
+    const GraphQLRequest m_revalidationRequest;
+    std::size_t m_revalidatedBegin = 0;
+    std::size_t m_revalidatedEnd = 0;
+    bool m_isRevalidating = false;
+    int m_staleIssues = 0;
 };
@@ -23,14 +23,19 @@ SOFTWARE. */
 #include "labelcreator.h"
 
 #include <iostream>
-#include <sstream>
 
 #include <nlohmann/json.hpp>
 
 #include "postdownloader.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    constexpr QueryTemplate LABEL_ALIAS{": createLabel(input: {color:\"FF0000\", name:\"%q\", repositoryId:\"%s\"}) { label { id } } "};
+}
+
 LabelCreator::LabelCreator(PostDownloader &downloader, std::string_view repoID,
                            std::unordered_map<std::string, std::vector<std::vector<int>::size_type>> &labelsToCreate,
                            std::string &error)
@@ -45,24 +50,25 @@ LabelCreator::LabelCreator(PostDownloader &downloader, std::string_view repoID,
 void LabelCreator::run()
 {
     // Sample QraphQL string for the mutation with one alias named 'label0'
-    // "{\"query\": \"mutation CreateLabel { label0: createLabel(input: {color:\\\"FF0000\\\", name:\\\"NAME\\\", repositoryId:\\\"REPO-ID\\\"}) { label { id } } }\"}"
-    const std::string start = "{\"query\": \"mutation CreateLabel { ";
-    const std::string end = "}\"}";
+    // "mutation CreateLabel { label0: createLabel(input: {color:\"FF0000\", name:\"NAME\", repositoryId:\"REPO-ID\"}) { label { id } } }"
+    std::string buffer = "mutation CreateLabel { ";
 
     int counter = 0;
-    std::ostringstream buffer;
-    buffer << start;
     for (const auto &pair : m_labelsToCreate) {
         const std::string &label = pair.first;
         std::string alias;
-        buffer << makeLabelAlias(counter, label, alias);
+        writeLabelAlias(buffer, counter, label, alias);
         m_labelAliases[alias] = label;
         ++counter;
     }
-    buffer << end;
+    buffer += "}";
 
     m_downloader.setFinishedHandler(beast::bind_front_handler(&LabelCreator::onFinishedPage, this));
-    m_downloader.setRequestBody(buffer.str());
+
+    json req;
+    req["query"] = buffer;
+    m_downloader.setRequestBody(req.dump());
+
     m_downloader.run();
     m_downloader.setFinishedHandler(FinishedHandler{});
 }
@@ -109,16 +115,9 @@ void LabelCreator::gatherLabelIDs(std::string_view response)
     }
 }
 
-std::string LabelCreator::makeLabelAlias(const int counter, const std::string &name, std::string &alias)
+void LabelCreator::writeLabelAlias(std::string &buffer, const int counter, const std::string &name, std::string &alias)
 {
-    const std::string part1 = ": createLabel(input: {color:\\\"FF0000\\\", name:\\\"";
-    const std::string part2 = "\\\", repositoryId:\\\"";
-    const std::string part3 = "\\\"}) { label { id } } ";
-
-    std::ostringstream buffer;
-    buffer << "label" << counter;
-    alias = buffer.str();
-    buffer << part1 << name << part2 << m_repoID << part3;
-
-    return buffer.str();
+    alias = "label" + std::to_string(counter);
+    buffer += alias;
+    writeQuery<LABEL_ALIAS>(buffer, name, m_repoID);
 }
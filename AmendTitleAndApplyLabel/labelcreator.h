@@ -42,7 +42,7 @@ private:
     void onFinishedPage();
 
     void gatherLabelIDs(std::string_view response);
-    std::string makeLabelAlias(const int counter, const std::string &name, std::string &alias);
+    void writeLabelAlias(std::string &buffer, const int counter, const std::string &name, std::string &alias);
 
     PostDownloader &m_downloader;
     std::unordered_map<std::string, std::vector<std::vector<int>::size_type>> &m_labelsToCreate;
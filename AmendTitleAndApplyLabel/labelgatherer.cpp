@@ -22,15 +22,49 @@ SOFTWARE. */
 
 #include "labelgatherer.h"
 
+#include <algorithm>
 #include <iostream>
 
+#include <boost/algorithm/string/predicate.hpp>
+
 #include <nlohmann/json.hpp>
 
+#include "bootstrapquery.h"
+#include "connectionreader.h"
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    constexpr QueryTemplate LABELS_QUERY{"query($owner: String!, $name: String!, $after: String) { "
+                                         "repository(owner:$owner, name:$name) { id "
+                                         "labels(first:100, after:$after) { nodes { id name } pageInfo { endCursor hasNextPage } } } }"};
+    static_assert(LABELS_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate LOOKUP_ALIAS{"l%n: label(name:$l%n) { id name } "};
+
+    // A label of a page, read by readConnection()
+    struct LabelNode {
+        std::string id;
+        std::string name;
+
+        void set(const FieldPath &path, std::string &value)
+        {
+            if (path.is({"id"}))
+                id = std::move(value);
+            else if (path.is({"name"}))
+                name = std::move(value);
+        }
+
+        void set(const FieldPath &, long long)
+        {
+        }
+    };
+}
+
 LabelGatherer::LabelGatherer(const ProgramOptions &programOptions, PostDownloader &downloader,
                            std::unordered_map<std::string, std::string> &labels,
                            std::string &error)
@@ -38,16 +72,30 @@ LabelGatherer::LabelGatherer(const ProgramOptions &programOptions, PostDownloade
     , m_downloader(downloader)
     , m_labels(labels)
     , m_error(error)
-    , m_body1part(generateBody1Part())
-    , m_body2part(") { nodes { id name } pageInfo { endCursor hasNextPage } } } }\" }")
+    , m_request(LABELS_QUERY.text(), {{"owner", programOptions.repoOwner}, {"name", programOptions.repoName}})
+    , m_labelNames(labelNames(programOptions))
 {
     m_error.clear();
 }
 
-void LabelGatherer::run()
+void LabelGatherer::run(std::string_view lookupResponse)
 {
+    // The labels are looked up by name with one request, possibly the bootstrap query.
+    // The labels that weren't found don't exist and are left for the caller to create.
+    // All the labels are scanned only if the lookup response can't be used.
+    if (lookupResponse.empty()) {
+        BootstrapQuery query{m_programOptions};
+        addLookup(m_programOptions, query);
+        m_downloader.setRequestBody(query.body());
+    }
+    else {
+        if (lookupLabels(lookupResponse) || !m_error.empty())
+            return;
+
+        startScan();
+    }
+
     m_downloader.setFinishedHandler(beast::bind_front_handler(&LabelGatherer::onFinishedPage, this));
-    m_downloader.setRequestBody(m_body1part + m_body2part);
     m_downloader.run();
     m_downloader.setFinishedHandler(FinishedHandler{});
 }
@@ -59,6 +107,17 @@ void LabelGatherer::onFinishedPage()
         return;
     }
 
+    if (!m_isScanning) {
+        const bool isFound = (m_downloader.response().base().result() == http::status::ok)
+                && lookupLabels(m_downloader.response().body());
+
+        if (!isFound && m_error.empty()) {
+            startScan();
+            m_downloader.sendRequest();
+        }
+        return;
+    }
+
     if (m_downloader.response().base().result() != http::status::ok) {
         m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
         return;
@@ -67,39 +126,101 @@ void LabelGatherer::onFinishedPage()
     gatherLabels(m_downloader.response().body());
 
     if (m_error.empty() && m_hasNext) {
-        const std::string body = m_body1part + ", after:\\\"" + m_cursor + "\\\"" + m_body2part;
-
-        m_downloader.setRequestBody(body);
+        m_downloader.setRequestBody(m_request.body({{"after", m_cursor}}));
         m_downloader.sendRequest();
 
         std::cout << "Downloading next Labels cursor: " << m_cursor << std::endl;
     }
 }
 
-void LabelGatherer::gatherLabels(std::string_view response)
+// Returns false if the response can't be used, eg the query was rejected
+bool LabelGatherer::lookupLabels(std::string_view response)
 {
     try {
         const json data = json::parse(response);
-        if (data.contains("errors")) {
-            m_error = "The last API call returned an error:\n" + data.dump();
-            return;
+        // A missing label comes back as null without an error
+        if (!data.contains("data") || data["data"].is_null() || data.contains("errors"))
+            return false;
+
+        const json &repo = data["data"]["repository"];
+        m_repoId = repo["id"].get<std::string>();
+
+        for (std::vector<std::string>::size_type i = 0; i < m_labelNames.size(); ++i) {
+            const json &label = repo["l" + std::to_string(i)];
+            if (label.is_object())
+                m_labels[label["name"].get<std::string>()] = label["id"].get<std::string>();
         }
+    }
+    catch (const std::exception &) {
+        m_labels.clear();
+        return false;
+    }
+
+    return true;
+}
 
-        if (m_repoId.empty()) {
-            const json repo = data["data"]["repository"];
-            m_repoId = repo["id"].get<std::string>();
+void LabelGatherer::addLookup(const ProgramOptions &programOptions, BootstrapQuery &query)
+{
+    // Sample QraphQL fields with one label
+    // "l0: label(name:$l0) { id name }"
+    const std::vector<std::string> names = labelNames(programOptions);
+    std::string aliases;
+
+    for (std::vector<std::string>::size_type i = 0; i < names.size(); ++i) {
+        query.addVariable("$l" + std::to_string(i) + ": String!", names[i]);
+        writeQuery<LOOKUP_ALIAS>(aliases, i, i);
+    }
+    query.addRepositoryFields(aliases);
+}
+
+std::vector<std::string> LabelGatherer::labelNames(const ProgramOptions &programOptions)
+{
+    // The same label might be applied to multiple regexes
+    std::vector<std::string> names;
+
+    for (const std::string &name : programOptions.labelList) {
+        const auto pred = [&name](const std::string &other)
+        {
+            return boost::iequals(name, other);
+        };
+
+        if (std::none_of(names.cbegin(), names.cend(), pred))
+            names.push_back(name);
+    }
+
+    return names;
+}
+
+void LabelGatherer::startScan()
+{
+    m_isScanning = true;
+    m_downloader.setRequestBody(m_request.body());
+
+    std::cout << "The labels couldn't be looked up by name, scanning all the labels" << std::endl;
+}
+
+void LabelGatherer::gatherLabels(std::string_view response)
+{
+    try {
+        Connection<LabelNode> labels = readConnection<LabelNode>(response, {"data", "repository", "labels"});
+        if (labels.hasErrors) {
+            m_error = "The last API call returned an error:\n" + json::parse(response).dump();
+            return;
         }
 
-        const json nodes = data["data"]["repository"]["labels"]["nodes"];
-        for (const auto &node : nodes) {
-            const std::string id = node["id"].get<std::string>();
-            const std::string name = node["name"].get<std::string>();
-            m_labels[name] = id;
+        if (!labels.isFound) {
+            m_error = "The API response has no labels:\n" + std::string(response);
+            return;
         }
 
-        const json pageinfo = data["data"]["repository"]["labels"]["pageInfo"];
-        m_hasNext = pageinfo["hasNextPage"].get<bool>();
-        m_cursor = pageinfo["endCursor"].get<std::string>();
+        if (m_repoId.empty())
+            m_repoId = std::move(labels.parentID);
+
+        for (LabelNode &node : labels.nodes)
+            m_labels[std::move(node.name)] = std::move(node.id);
+
+        m_hasNext = labels.pageInfo.hasNext;
+        m_cursor = std::move(labels.pageInfo.cursor);
     }
     catch (const std::exception &e) {
         m_error += "Exception: ";
@@ -107,16 +228,12 @@ void LabelGatherer::gatherLabels(std::string_view response)
     }
 }
 
-std::string LabelGatherer::generateBody1Part()
+std::string LabelGatherer::repoId()
 {
-    return "{\"query\": \"query { repository(owner:\\\"" +
-            m_programOptions.repoOwner +
-            "\\\", name:\\\"" +
-            m_programOptions.repoName +
-            "\\\") { id labels(first:100";
+    return m_repoId;
 }
 
-std::string LabelGatherer::repoId()
+std::string_view LabelGatherer::queryDocument()
 {
-    return m_repoId;
+    return LABELS_QUERY.text();
 }
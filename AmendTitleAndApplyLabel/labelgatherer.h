@@ -26,6 +26,9 @@ SOFTWARE. */
 #include <unordered_map>
 #include <vector>
 
+#include "graphqlrequest.h"
+
+class BootstrapQuery;
 class ProgramOptions;
 class PostDownloader;
 
@@ -37,14 +40,23 @@ public:
                            std::unordered_map<std::string, std::string> &labels,
                            std::string &error);
 
-    void run();
+    // The response of the lookup may come from the bootstrap query
+    void run(std::string_view lookupResponse = {});
     std::string repoId();
 
+    // The GraphQL document of each page of the scan, used to estimate its cost
+    static std::string_view queryDocument();
+    // Adds the lookup of the labels by name to the bootstrap query
+    static void addLookup(const ProgramOptions &programOptions, BootstrapQuery &query);
+
 private:
     void onFinishedPage();
 
+    void startScan();
+    bool lookupLabels(std::string_view response);
     void gatherLabels(std::string_view response);
-    std::string generateBody1Part();
+    // The distinct names of the labels to apply
+    static std::vector<std::string> labelNames(const ProgramOptions &programOptions);
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
@@ -52,9 +64,10 @@ private:
     std::string &m_error;
 
 
-    const std::string m_body1part;
-    const std::string m_body2part;
+    const GraphQLRequest m_request;
+    const std::vector<std::string> m_labelNames;
     std::string m_repoId;
     std::string m_cursor;
     bool m_hasNext = false;
+    bool m_isScanning = false;
 };
@@ -20,12 +20,18 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <thread>
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include "bootstrapquery.h"
+#include "executionplanner.h"
 #include "issueattributes.h"
 #include "issuegatherer.h"
+#include "issuesearcher.h"
 #include "issueupdater.h"
 #include "labelcreator.h"
 #include "labelgatherer.h"
@@ -35,13 +41,8 @@ SOFTWARE. */
 
 void updateLabelIDs(std::vector<IssueAttributes> &issues, std::string_view labelID)
 {
-    for (auto &issue : issues) {
-        std::vector<std::string> &IDs = issue.labelIDs;
-        auto iter = find(IDs.cbegin(), IDs.cend(), labelID);
-
-        if (iter == IDs.cend())
-            IDs.emplace_back(labelID);
-    }
+    for (auto &issue : issues)
+        issue.labelID = labelID;
 }
 
 std::unordered_map<std::string, std::vector<std::vector<int>::size_type>>
@@ -85,6 +86,74 @@ updateLabelsPerRegex(std::unordered_map<std::vector<int>::size_type, std::vector
     return labelsToCreate;
 }
 
+// Paginates the open issues from both ends at once until the two directions meet.
+// The first forward page may come from the response of the bootstrap query.
+void gatherIssues(const ProgramOptions &options, PostDownloader &downloader,
+                  std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues,
+                  std::string &error, std::string_view firstPage)
+{
+    PostDownloader backwardDownloader(options);
+    if (!backwardDownloader.error().empty()) {
+        error = backwardDownloader.error();
+        return;
+    }
+
+    PaginationMeeting meeting;
+    std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> backwardIssues;
+    std::string backwardError;
+
+    // The arguments must outlive the class instance
+    IssueGatherer forwardGatherer{options, downloader, issues, error, IssueGatherer::Direction::Forward, meeting};
+    IssueGatherer backwardGatherer{options, backwardDownloader, backwardIssues, backwardError, IssueGatherer::Direction::Backward, meeting};
+
+    // run() runs the io_context and blocks
+    // Each PostDownloader has its own io_context, so the two directions run on separate threads
+    std::thread backwardThread([&backwardGatherer]() { backwardGatherer.run(); });
+    forwardGatherer.run(firstPage);
+    backwardThread.join();
+
+    if (error.empty())
+        error = backwardError;
+
+    for (auto &pair : backwardIssues) {
+        std::vector<IssueAttributes> &subIssues = issues[pair.first];
+        subIssues.insert(subIssues.end(), std::make_move_iterator(pair.second.begin()), std::make_move_iterator(pair.second.end()));
+    }
+}
+
+// Keeps only the newest `count` issues across all the regexes, so the same issues are kept on every run.
+// The map and the two gathering directions don't keep any order.
+void limitIssues(std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>> &issues, std::size_t count)
+{
+    std::vector<int> numbers;
+    for (const auto &pair : issues) {
+        for (const IssueAttributes &issue : pair.second)
+            numbers.push_back(issue.number);
+    }
+
+    if (numbers.size() <= count)
+        return;
+
+    if (count == 0) {
+        issues.clear();
+        return;
+    }
+
+    std::nth_element(numbers.begin(), numbers.begin() + (count - 1), numbers.end(), std::greater<int>());
+    const int oldestKept = numbers[count - 1];
+
+    for (auto iter = issues.begin(); iter != issues.end();) {
+        std::vector<IssueAttributes> &subIssues = iter->second;
+        const auto isOlder = [oldestKept](const IssueAttributes &issue) { return issue.number < oldestKept; };
+        subIssues.erase(std::remove_if(subIssues.begin(), subIssues.end(), isOlder), subIssues.end());
+
+        if (subIssues.empty())
+            iter = issues.erase(iter);
+        else
+            ++iter;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     std::string error;
@@ -102,10 +171,42 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // Without the required words of every regex the search can't find all the candidates
+    const bool useSearch = options.useSearch && !IssueSearcher::searchQueries(options).empty();
+    if (options.useSearch && !useSearch)
+        std::cout << "Some regex doesn't require any whole word, scanning all the open issues" << std::endl;
+
+    // The first forward issue page and the label lookups are sent along with the probe of the planner
+    BootstrapQuery bootstrap{options};
+    if (!useSearch)
+        IssueGatherer::addFirstPage(bootstrap);
+    LabelGatherer::addLookup(options, bootstrap);
+
     // The arguments must outlive the class instance
-    IssueGatherer issueGatherer{options, downloader, issues, error};
+    ExecutionPlanner planner{options, downloader, bootstrap, error};
     // run() runs the io_context and blocks
-    issueGatherer.run();
+    planner.run();
+
+    if (!error.empty()) {
+        std::cout << error << std::endl;
+        return -1;
+    }
+
+    if (useSearch) {
+        // The arguments must outlive the class instance
+        IssueSearcher searcher{options, downloader, issues, error};
+        // run() runs the io_context and blocks
+        searcher.run();
+
+        if (error.empty() && !searcher.isComplete()) {
+            std::cout << "A search matched too many issues, scanning all the open issues" << std::endl;
+            issues.clear();
+            gatherIssues(options, downloader, issues, error, {});
+        }
+    }
+    else {
+        gatherIssues(options, downloader, issues, error, planner.bootstrapResponse());
+    }
 
     if (!error.empty()) {
         std::cout << error << std::endl;
@@ -117,14 +218,20 @@ int main(int argc, char *argv[])
         return 0;
     }
 
-    for (const auto &pair : issues)
+    std::size_t matchedIssues = 0;
+    for (const auto &pair : issues) {
         std::cout << pair.second.size() << " issues matching regex at " << pair.first << " pos" << std::endl;
+        matchedIssues += pair.second.size();
+    }
+
+    // Leave the rest for a later run instead of running out of points halfway
+    limitIssues(issues, planner.planUpdates(matchedIssues));
 
     std::unordered_map<std::string, std::string> labels;
     // The arguments must outlive the class instance
     LabelGatherer labelGatherer{options, downloader, labels, error};
     // run() runs the io_context and blocks
-    labelGatherer.run();
+    labelGatherer.run(planner.bootstrapResponse());
 
     if (!error.empty()) {
         std::cout << error << std::endl;
@@ -0,0 +1,157 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "mutationqueue.h"
+
+#include <algorithm>
+
+namespace
+{
+    using namespace std::chrono_literals;
+
+    constexpr auto INITIAL_BACKOFF = 2s;
+    constexpr auto MAX_BACKOFF = 60s;
+}
+
+MutationQueue::MutationQueue(std::size_t issues, Steps steps, int maxAttempts)
+    : m_issues(issues)
+    , m_steps(steps)
+    , m_maxAttempts(maxAttempts)
+    , m_isSkipped(issues, false)
+{
+}
+
+bool MutationQueue::empty() const
+{
+    return m_pending.empty() && (m_nextIssue == m_issues);
+}
+
+std::chrono::steady_clock::duration MutationQueue::waitTime(TimePoint now) const
+{
+    if (m_nextIssue < m_issues)
+        return {};
+
+    std::chrono::steady_clock::duration wait = std::chrono::steady_clock::duration::max();
+    for (const Item &item : m_pending)
+        wait = std::min(wait, std::max(item.notBefore - now, std::chrono::steady_clock::duration::zero()));
+
+    return (wait == std::chrono::steady_clock::duration::max()) ? std::chrono::steady_clock::duration::zero() : wait;
+}
+
+std::size_t MutationQueue::nextIssue() const
+{
+    return m_nextIssue;
+}
+
+void MutationQueue::skipIssue(std::size_t issue)
+{
+    if (issue < m_nextIssue)
+        return;
+
+    m_isSkipped[issue] = true;
+    // m_nextIssue never points to a skipped issue, so empty() stays accurate
+    while ((m_nextIssue < m_issues) && m_isSkipped[m_nextIssue])
+        ++m_nextIssue;
+}
+
+const MutationQueue::Item *MutationQueue::takeReady(TimePoint now)
+{
+    const auto isReady = [now](const Item &item) { return item.notBefore <= now; };
+    const auto iter = std::find_if(m_pending.begin(), m_pending.end(), isReady);
+
+    if (iter != m_pending.end()) {
+        m_batch.push_back(*iter);
+        m_pending.erase(iter);
+    }
+    else if (m_nextIssue < m_issues) {
+        m_batch.push_back({m_nextIssue++, m_steps});
+        while ((m_nextIssue < m_issues) && m_isSkipped[m_nextIssue])
+            ++m_nextIssue;
+    }
+    else {
+        return nullptr;
+    }
+
+    return &m_batch.back();
+}
+
+void MutationQueue::addAlias(std::string alias, Steps steps)
+{
+    m_aliases.push_back({std::move(alias), m_batch.size() - 1, steps});
+}
+
+int MutationQueue::batchSize() const
+{
+    return static_cast<int>(m_batch.size());
+}
+
+MutationQueue::Steps MutationQueue::batchSteps() const
+{
+    Steps steps = 0;
+    for (const Alias &alias : m_aliases) {
+        if (!alias.name.empty())
+            steps |= alias.steps;
+    }
+
+    return steps;
+}
+
+void MutationQueue::rewindBatch()
+{
+    m_pending.insert(m_pending.begin(), m_batch.cbegin(), m_batch.cend());
+    m_batch.clear();
+    m_aliases.clear();
+}
+
+MutationQueue::BatchResult MutationQueue::finishBatch(const std::function<bool (const std::string &)> &succeeded, TimePoint now)
+{
+    BatchResult result;
+    std::vector<Steps> failedSteps(m_batch.size(), 0);
+
+    for (const Alias &alias : m_aliases) {
+        if (alias.name.empty() || succeeded(alias.name))
+            m_batch[alias.batchIndex].steps &= ~alias.steps;
+        else
+            result.failedAliases.push_back(alias.name);
+    }
+
+    for (Item &item : m_batch) {
+        if (item.steps == 0) {
+            ++result.completedIssues;
+            continue;
+        }
+
+        if (++item.attempts >= m_maxAttempts) {
+            result.abandonedIssues.push_back(item.issue);
+            continue;
+        }
+
+        // Exponential backoff
+        const auto backoff = std::min<std::chrono::steady_clock::duration>(INITIAL_BACKOFF * (1 << (item.attempts - 1)), MAX_BACKOFF);
+        item.notBefore = now + backoff;
+        m_pending.push_back(item);
+    }
+
+    m_batch.clear();
+    m_aliases.clear();
+    return result;
+}
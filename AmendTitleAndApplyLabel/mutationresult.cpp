@@ -0,0 +1,120 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "mutationresult.h"
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "jsonbackend.h"
+
+namespace
+{
+    // The SAX handler of parseJson(). Only the keys of the response and of "data" matter,
+    // the payloads of the aliases are skipped.
+    class Reader
+    {
+    public:
+        explicit Reader(MutationResult &result)
+            : m_result(result)
+        {
+        }
+
+        bool null() { return value(false); }
+        bool boolean(bool) { return value(true); }
+        bool number_integer(nlohmann::json::number_integer_t) { return value(true); }
+        bool number_unsigned(nlohmann::json::number_unsigned_t) { return value(true); }
+        bool number_float(nlohmann::json::number_float_t, const std::string &) { return value(true); }
+        bool string(std::string &) { return value(true); }
+
+        bool start_object(std::size_t)
+        {
+            if ((m_depth == 1) && (m_responseKey == "data"))
+                m_result.hasData = true;
+            else
+                value(true);
+
+            ++m_depth;
+            return true;
+        }
+
+        bool key(std::string &value)
+        {
+            if (m_depth == 1)
+                m_responseKey.assign(value);
+            else if ((m_depth == 2) && m_result.hasData && (m_responseKey == "data"))
+                m_alias.assign(value);
+            return true;
+        }
+
+        bool end_object()
+        {
+            --m_depth;
+            return true;
+        }
+
+        bool start_array(std::size_t)
+        {
+            value(true);
+            ++m_depth;
+            return true;
+        }
+
+        bool end_array()
+        {
+            --m_depth;
+            return true;
+        }
+
+    private:
+        // Called with every value where it starts
+        bool value(bool isPresent)
+        {
+            if (!isPresent)
+                return true;
+
+            if ((m_depth == 1) && (m_responseKey == "errors"))
+                m_result.hasErrors = true;
+            else if ((m_depth == 2) && m_result.hasData && (m_responseKey == "data"))
+                m_result.succeededAliases.insert(m_alias);
+            return true;
+        }
+
+        MutationResult &m_result;
+        std::size_t m_depth = 0;
+        // The current key of the response object and of "data"
+        std::string m_responseKey;
+        std::string m_alias;
+    };
+}
+
+MutationResult readMutationResult(std::string_view response)
+{
+    MutationResult result;
+    Reader reader(result);
+
+    std::string error;
+    if (!parseJson(response, reader, error))
+        throw std::runtime_error(error);
+
+    return result;
+}
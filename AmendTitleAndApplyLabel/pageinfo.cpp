@@ -0,0 +1,87 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "pageinfo.h"
+
+namespace
+{
+    using namespace std::literals;
+
+    // Inside a JSON string the quotes are escaped, so this only matches the actual key
+    constexpr std::string_view PAGE_INFO_KEY = "\"pageInfo\":{"sv;
+
+    // Returns the raw value of a scalar field of `object`, without the quotes of a string
+    std::optional<std::string_view> fieldValue(std::string_view object, std::string_view field)
+    {
+        std::string key;
+        key.reserve(field.size() + 3);
+        key += '"';
+        key += field;
+        key += "\":";
+
+        const auto pos = object.find(key);
+        if (pos == std::string_view::npos)
+            return {};
+
+        const std::string_view value = object.substr(pos + key.size());
+        if (!value.empty() && (value.front() == '"')) {
+            const auto end = value.find('"', 1);
+            // The cursors are base64, so an escape sequence means something unexpected
+            if ((end == std::string_view::npos) || (value.substr(1, end - 1).find('\\') != std::string_view::npos))
+                return {};
+
+            return value.substr(1, end - 1);
+        }
+
+        const auto end = value.find_first_of(",}");
+        if (end == std::string_view::npos)
+            return {};
+
+        return value.substr(0, end);
+    }
+}
+
+std::optional<PageInfo> scanPageInfo(std::string_view response, std::string_view cursorField,
+                                     std::string_view hasNextField)
+{
+    // The pageInfo comes after the nodes, so it is near the end of the response
+    const auto pos = response.rfind(PAGE_INFO_KEY);
+    if (pos == std::string_view::npos)
+        return {};
+
+    const std::string_view object = response.substr(pos + PAGE_INFO_KEY.size());
+    const std::optional<std::string_view> cursor = fieldValue(object, cursorField);
+    const std::optional<std::string_view> hasNext = fieldValue(object, hasNextField);
+    if (!cursor || !hasNext)
+        return {};
+
+    PageInfo pageInfo;
+    if (*hasNext == "true"sv)
+        pageInfo.hasNext = true;
+    else if (*hasNext != "false"sv)
+        return {};
+
+    if (*cursor != "null"sv)
+        pageInfo.cursor = *cursor;
+
+    return pageInfo;
+}
@@ -36,15 +36,8 @@ namespace {
 PostDownloader::PostDownloader(const ProgramOptions &programOptions)
     : m_ctx(boost::asio::ssl::context::tlsv12_client)
     , m_resolver(m_ioc)
-    , m_stream(m_ioc, m_ctx)
+    , m_timer(m_ioc)
 {
-    // Set SNI Hostname (many hosts need this to handshake successfully)
-    if(!SSL_set_tlsext_host_name(m_stream.native_handle(), TARGET.data())) {
-        beast::error_code ec{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
-        m_error = "Failed SNI: " + ec.message();
-        return;
-    }
-
     const std::string GITHUB_TOKEN = "token " + programOptions.authToken;
     // Set up an HTTP POST request message
     m_request.method(http::verb::post);
@@ -68,19 +61,47 @@ PostDownloader::~PostDownloader()
 
 void PostDownloader::initializeConnection()
 {
+    resolve();
+
+    m_ioc.run();
+    m_ioc.restart();
+}
+
+void PostDownloader::resolve()
+{
+    m_isOpenConnection = false;
+    m_stream.emplace(m_ioc, m_ctx);
+
+    // Set SNI Hostname (many hosts need this to handshake successfully)
+    if(!SSL_set_tlsext_host_name(m_stream->native_handle(), TARGET.data())) {
+        beast::error_code ec{static_cast<int>(::ERR_get_error()), net::error::get_ssl_category()};
+        failConnection("Failed SNI: " + ec.message());
+        return;
+    }
+
     m_resolver.async_resolve(HOST, PORT,
                              beast::bind_front_handler(
                                  &PostDownloader::onResolve,
                                  this));
+}
 
-    m_ioc.run();
-    m_ioc.restart();
+void PostDownloader::resendOnNewConnection()
+{
+    // The old stream is unusable. It is destroyed without a graceful shutdown.
+    m_error.clear();
+    m_buffer.clear();
+    m_sendAfterConnect = true;
+    resolve();
 }
 
 void PostDownloader::run()
 {
     sendRequest();
+    runSent();
+}
 
+void PostDownloader::runSent()
+{
     m_ioc.run();
     m_ioc.restart();
 }
@@ -88,15 +109,15 @@ void PostDownloader::run()
 void PostDownloader::onResolve(beast::error_code ec, tcp::resolver::results_type results)
 {
     if(ec) {
-        m_error = "Failed resolve: " + ec.message();
+        failConnection("Failed resolve: " + ec.message());
         return;
     }
 
     // Set a timeout on the operation
-    beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+    beast::get_lowest_layer(*m_stream).expires_after(std::chrono::seconds(30));
 
     // Make the connection on the IP address we get from a lookup
-    beast::get_lowest_layer(m_stream).async_connect(
+    beast::get_lowest_layer(*m_stream).async_connect(
                 results,
                 beast::bind_front_handler(
                     &PostDownloader::onConnect,
@@ -106,12 +127,12 @@ void PostDownloader::onResolve(beast::error_code ec, tcp::resolver::results_type
 void PostDownloader::onConnect(beast::error_code ec, tcp::resolver::results_type::endpoint_type)
 {
     if(ec) {
-        m_error = "Failed connect: " + ec.message();
+        failConnection("Failed connect: " + ec.message());
         return;
     }
 
     // Perform the SSL handshake
-    m_stream.async_handshake(
+    m_stream->async_handshake(
                 ssl::stream_base::client,
                 beast::bind_front_handler(
                     &PostDownloader::onHandshake,
@@ -121,19 +142,24 @@ void PostDownloader::onConnect(beast::error_code ec, tcp::resolver::results_type
 void PostDownloader::onHandshake(beast::error_code ec)
 {
     if(ec) {
-        m_error = "Failed handshake: " + ec.message();
+        failConnection("Failed handshake: " + ec.message());
         return;
     }
 
     m_isOpenConnection = true;
 
-   // this is the end of the procedure started by initializeConnection()
+    // this is the end of the procedure started by initializeConnection()
+    // unless the connection was re-established to send a request
+    if (m_sendAfterConnect) {
+        m_sendAfterConnect = false;
+        sendRequest();
+    }
 }
 
 void PostDownloader::onWrite(beast::error_code ec, std::size_t)
 {
     if(ec) {
-        m_error = "Failed write: " + ec.message();
+        fail("Failed write: " + ec.message());
         return;
     }
 
@@ -142,7 +168,7 @@ void PostDownloader::onWrite(beast::error_code ec, std::size_t)
     std::cout << m_request.body() << std::endl;*/
 
     // Receive the HTTP response
-    http::async_read(m_stream, m_buffer, m_response,
+    http::async_read(*m_stream, m_buffer, m_response,
                      beast::bind_front_handler(
                          &PostDownloader::onRead,
                          this));
@@ -151,7 +177,7 @@ void PostDownloader::onWrite(beast::error_code ec, std::size_t)
 void PostDownloader::onRead(beast::error_code ec, std::size_t)
 {
     if(ec) {
-        m_error = "Failed read: " + ec.message();
+        fail("Failed read: " + ec.message());
         return;
     }
 
@@ -181,6 +207,27 @@ void PostDownloader::onShutdown(beast::error_code ec)
     // If we get here then the connection is closed gracefully    
 }
 
+// The finished handler checks error() first, so it can retry the request or give up
+void PostDownloader::fail(std::string error)
+{
+    m_error = std::move(error);
+
+    if (m_finishedHanlder)
+        m_finishedHanlder();
+}
+
+// Only a connection that a request waits for reports its failure to the finished handler
+void PostDownloader::failConnection(std::string error)
+{
+    if (!m_sendAfterConnect) {
+        m_error = std::move(error);
+        return;
+    }
+
+    m_sendAfterConnect = false;
+    fail(std::move(error));
+}
+
 std::string_view PostDownloader::error() const
 {
     return m_error;
@@ -201,6 +248,11 @@ const http::response<http::string_body>& PostDownloader::response() const
     return m_response;
 }
 
+std::string PostDownloader::takeResponseBody()
+{
+    return std::move(m_response.body());
+}
+
 bool PostDownloader::isKeptAlive() const
 {
     return m_response.keep_alive();
@@ -213,22 +265,40 @@ void PostDownloader::sendRequest()
     m_request.prepare_payload();
 
     // Set a timeout on the operation
-    beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+    beast::get_lowest_layer(*m_stream).expires_after(std::chrono::seconds(30));
 
     // Send the HTTP request to the remote host
-    http::async_write(m_stream, m_request,
+    http::async_write(*m_stream, m_request,
                       beast::bind_front_handler(
                           &PostDownloader::onWrite,
                           this));
 }
 
+void PostDownloader::sendRequestAfter(std::chrono::steady_clock::duration delay)
+{
+    m_timer.expires_after(delay);
+    m_timer.async_wait(beast::bind_front_handler(
+                           &PostDownloader::onDelay,
+                           this));
+}
+
+void PostDownloader::onDelay(beast::error_code ec)
+{
+    if(ec) {
+        fail("Failed wait: " + ec.message());
+        return;
+    }
+
+    sendRequest();
+}
+
 void PostDownloader::closeConnection()
 {
     // Set a timeout on the operation
-    beast::get_lowest_layer(m_stream).expires_after(std::chrono::seconds(30));
+    beast::get_lowest_layer(*m_stream).expires_after(std::chrono::seconds(30));
 
     // Gracefully close the stream
-    m_stream.async_shutdown(
+    m_stream->async_shutdown(
                 beast::bind_front_handler(
                     &PostDownloader::onShutdown,
                     this));
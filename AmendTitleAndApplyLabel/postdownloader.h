@@ -22,9 +22,12 @@ SOFTWARE. */
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string>
 #include <string_view>
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
@@ -48,13 +51,23 @@ public:
 
     // Start the asynchronous operation
     void run();
+    // Like run(), for a request that the caller already started, eg with sendRequestAfter()
+    void runSent();
 
     std::string_view error() const;
+    // Called when a response arrived or the request failed with a transport error
     void setFinishedHandler(FinishedHandler handler);
     void setRequestBody(std::string_view body);
     const http::response<http::string_body>& response() const;
+    // Moves the body out of the response, so it outlives the next request
+    std::string takeResponseBody();
     bool isKeptAlive() const;
     void sendRequest();
+    // Sends the request once the delay expires, eg to back off before a retry
+    void sendRequestAfter(std::chrono::steady_clock::duration delay);
+    // Drops the current connection and sends the request again on a new one.
+    // Use it after the connection broke (eg a timeout) while inside a finished handler.
+    void resendOnNewConnection();
     void closeConnection();
 
 private:
@@ -65,8 +78,12 @@ private:
     void onWrite(beast::error_code ec, std::size_t);
     void onRead(beast::error_code ec, std::size_t);
     void onShutdown(beast::error_code ec);
+    void onDelay(beast::error_code ec);
 
     void initializeConnection();
+    void resolve();
+    void fail(std::string error);
+    void failConnection(std::string error);
 
     // Private members
     // The io_context is required for all I/O
@@ -78,11 +95,13 @@ private:
     http::request<http::string_body> m_request;
     http::response<http::string_body> m_response;
     tcp::resolver m_resolver;
-    beast::ssl_stream<beast::tcp_stream> m_stream;
+    net::steady_timer m_timer;
+    std::optional<beast::ssl_stream<beast::tcp_stream>> m_stream;
 
     std::string m_error;
     std::string m_body;
     FinishedHandler m_finishedHanlder;
 
     bool m_isOpenConnection = false;
+    bool m_sendAfterConnect = false;
 };
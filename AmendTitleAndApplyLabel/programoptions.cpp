@@ -51,6 +51,7 @@ ProgramOptions ProgramOptions::parseCmdLine(int &argc, char *argv[], std::string
 
     po::options_description optional("Optional");
     optional.add_options()
+            ("use-search", po::bool_switch(&opt.useSearch), "Find the candidate issues with the search API, from the whole words that each regex requires, instead of scanning all the open issues. It falls back to the scan if a regex requires no whole word or a search matches more than 1000 issues.")
             ("dry-run", po::bool_switch(&opt.dryRun), "Don't perform any changes/mutations on the given repo. Perform only the queries and print relevant information.")
     ;
 
@@ -68,10 +69,10 @@ ProgramOptions ProgramOptions::parseCmdLine(int &argc, char *argv[], std::string
     }
 
     if (error.empty()) {
-        std::vector<std::string> list = vm["regex"].as<std::vector<std::string>>();
-        opt.regexList.reserve(list.size());
+        opt.regexPatterns = vm["regex"].as<std::vector<std::string>>();
+        opt.regexList.reserve(opt.regexPatterns.size());
 
-        for (const auto &str: list) {
+        for (const auto &str: opt.regexPatterns) {
             try {
                 opt.regexList.emplace_back(str, std::regex::icase|std::regex::optimize);
             }
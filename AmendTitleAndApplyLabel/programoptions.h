@@ -34,7 +34,10 @@ struct ProgramOptions {
     std::string authToken;
     std::string userAgent;
     std::vector<std::regex> regexList;
+    // The source of each regex in regexList
+    std::vector<std::string> regexPatterns;
     std::vector<std::string> labelList;
+    bool useSearch;
     bool dryRun;
 };
 
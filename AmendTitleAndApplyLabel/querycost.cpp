@@ -0,0 +1,165 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "querycost.h"
+
+#include <cctype>
+#include <vector>
+
+namespace
+{
+    constexpr long long MAX_PAGE_SIZE = 100;
+
+    bool isNameChar(const char ch)
+    {
+        return (std::isalnum(static_cast<unsigned char>(ch)) != 0) || (ch == '_');
+    }
+
+    // Returns the position after the string literal that starts at `pos`
+    std::string_view::size_type skipString(std::string_view document, std::string_view::size_type pos)
+    {
+        for (++pos; pos < document.size(); ++pos) {
+            if (document[pos] == '\\')
+                ++pos;
+            else if (document[pos] == '"')
+                return pos + 1;
+        }
+
+        return pos;
+    }
+
+    // Parses the arguments that start at `pos` (an opening parenthesis)
+    // and returns the value of their `first` or `last` argument, or 0 if there is none
+    long long parseArguments(std::string_view document, std::string_view::size_type &pos)
+    {
+        long long pageSize = 0;
+        int depth = 0;
+
+        while (pos < document.size()) {
+            const char ch = document[pos];
+
+            if (ch == '"') {
+                pos = skipString(document, pos);
+                continue;
+            }
+
+            if ((ch == '(') || (ch == '{') || (ch == '[')) {
+                ++depth;
+            }
+            else if ((ch == ')') || (ch == '}') || (ch == ']')) {
+                if (--depth == 0) {
+                    ++pos;
+                    break;
+                }
+            }
+            else if ((depth == 1) && isNameChar(ch) && !isNameChar(document[pos - 1]) && (document[pos - 1] != '$')) {
+                const auto begin = pos;
+                while ((pos < document.size()) && isNameChar(document[pos]))
+                    ++pos;
+
+                const std::string_view name = document.substr(begin, pos - begin);
+                if ((name != "first") && (name != "last"))
+                    continue;
+
+                while ((pos < document.size()) && ((document[pos] == ' ') || (document[pos] == ':')))
+                    ++pos;
+
+                if ((pos < document.size()) && (document[pos] == '$')) {
+                    pageSize = MAX_PAGE_SIZE;
+                    continue;
+                }
+
+                long long value = 0;
+                while ((pos < document.size()) && std::isdigit(static_cast<unsigned char>(document[pos]))) {
+                    value = (value * 10) + (document[pos] - '0');
+                    ++pos;
+                }
+                pageSize = value;
+                continue;
+            }
+
+            ++pos;
+        }
+
+        return pageSize;
+    }
+}
+
+int QueryCost::points() const
+{
+    const long long points = (requests + 50) / 100;
+    return (points < 1) ? 1 : static_cast<int>(points);
+}
+
+QueryCost estimateQueryCost(std::string_view document)
+{
+    QueryCost cost;
+    // How many times the current selection set is fetched
+    std::vector<long long> multipliers{1};
+    // Page size of the field whose arguments were parsed last, 0 if it isn't a connection
+    long long pageSize = 0;
+
+    std::string_view::size_type pos = 0;
+    while (pos < document.size()) {
+        const char ch = document[pos];
+
+        if (ch == '"') {
+            pos = skipString(document, pos);
+        }
+        else if (ch == '#') {
+            while ((pos < document.size()) && (document[pos] != '\n'))
+                ++pos;
+        }
+        else if (ch == '(') {
+            pageSize = parseArguments(document, pos);
+        }
+        else if (ch == '{') {
+            long long multiplier = multipliers.back();
+            if (pageSize > 0) {
+                cost.requests += multiplier;
+                cost.nodes += multiplier * pageSize;
+                multiplier *= pageSize;
+            }
+
+            multipliers.push_back(multiplier);
+            pageSize = 0;
+            ++pos;
+        }
+        else if (ch == '}') {
+            if (multipliers.size() > 1)
+                multipliers.pop_back();
+            pageSize = 0;
+            ++pos;
+        }
+        else if (isNameChar(ch)) {
+            // A new field, or a fragment type condition, which isn't a connection until proven otherwise
+            while ((pos < document.size()) && isNameChar(document[pos]))
+                ++pos;
+            pageSize = 0;
+        }
+        else {
+            ++pos;
+        }
+    }
+
+    return cost;
+}
@@ -0,0 +1,213 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "regexwords.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    enum class TokenType
+    {
+        Literal,  // a character that is always matched
+        Boundary, // a zero-width word boundary: ^, $ or \b
+        Unknown   // anything else, that might match word characters
+    };
+
+    struct Token {
+        TokenType type;
+        char ch;
+    };
+
+    bool isWordChar(const char ch)
+    {
+        // The bytes of multibyte UTF-8 characters count as word characters, because their tokenization is unknown
+        const auto uch = static_cast<unsigned char>(ch);
+        return (std::isalnum(uch) != 0) || (ch == '_') || (uch >= 0x80);
+    }
+
+    // Characters like '.' or '-' might be part of a search token, eg "v1.2"
+    bool isSeparator(const char ch)
+    {
+        return (std::isspace(static_cast<unsigned char>(ch)) != 0) || (std::string_view("[](){}<>:;!?\"").find(ch) != std::string_view::npos);
+    }
+
+    // An anchor or \b doesn't bound a search word, as "\bWIP\b" also matches "WIP-2" where "WIP" isn't a search token
+    bool isBound(const Token &token)
+    {
+        return (token.type == TokenType::Literal) && isSeparator(token.ch);
+    }
+
+    bool isSearchWord(std::string_view word)
+    {
+        return std::all_of(word.cbegin(), word.cend(), [](const char ch)
+        {
+            return std::isalnum(static_cast<unsigned char>(ch)) != 0;
+        });
+    }
+
+    // Returns the position of the character that closes the group or class starting at `pos`
+    std::string_view::size_type skipNested(std::string_view pattern, std::string_view::size_type pos)
+    {
+        int depth = 0;
+        bool inClass = false;
+
+        for (; pos < pattern.size(); ++pos) {
+            const char ch = pattern[pos];
+
+            if (ch == '\\') {
+                ++pos;
+            }
+            else if (inClass) {
+                if (ch == ']') {
+                    inClass = false;
+                    if (depth == 0)
+                        return pos;
+                }
+            }
+            else if (ch == '[') {
+                inClass = true;
+                // A ']' right after the '[' or '[^' is a member of the class
+                if ((pos + 1 < pattern.size()) && (pattern[pos + 1] == '^'))
+                    ++pos;
+                if ((pos + 1 < pattern.size()) && (pattern[pos + 1] == ']'))
+                    ++pos;
+            }
+            else if (ch == '(') {
+                ++depth;
+            }
+            else if (ch == ')') {
+                if (--depth == 0)
+                    return pos;
+            }
+        }
+
+        return pattern.size();
+    }
+
+    // The quantified atom might be matched zero or many times
+    void quantifyLastToken(std::vector<Token> &tokens)
+    {
+        if (!tokens.empty() && (tokens.back().type == TokenType::Literal))
+            tokens.back().type = TokenType::Unknown;
+    }
+
+    // Returns false if the pattern has an alternation outside of a group
+    bool tokenize(std::string_view pattern, std::vector<Token> &tokens)
+    {
+        for (std::string_view::size_type pos = 0; pos < pattern.size(); ++pos) {
+            const char ch = pattern[pos];
+
+            switch (ch) {
+            case '|':
+                return false;
+            case '^':
+            case '$':
+                tokens.push_back({TokenType::Boundary, ch});
+                break;
+            case '.':
+                tokens.push_back({TokenType::Unknown, ch});
+                break;
+            case '(':
+            case '[':
+                pos = skipNested(pattern, pos);
+                tokens.push_back({TokenType::Unknown, ch});
+                break;
+            case '*':
+            case '?':
+                quantifyLastToken(tokens);
+                break;
+            case '{':
+                quantifyLastToken(tokens);
+                pos = std::min(pattern.find('}', pos), pattern.size());
+                break;
+            case '+':
+                // The atom is matched at least once, but what follows it might be another repetition
+                tokens.push_back({TokenType::Unknown, ch});
+                break;
+            case '\\': {
+                if (++pos == pattern.size())
+                    return true;
+
+                const char escaped = pattern[pos];
+                if (escaped == 'b') {
+                    tokens.push_back({TokenType::Boundary, escaped});
+                }
+                else if ((escaped == 'n') || (escaped == 'r') || (escaped == 't') || (escaped == 'f') || (escaped == 'v')) {
+                    tokens.push_back({TokenType::Literal, ' '});
+                }
+                else if (std::isalnum(static_cast<unsigned char>(escaped)) != 0) {
+                    // Character classes, back references and character codes
+                    tokens.push_back({TokenType::Unknown, escaped});
+                    if (escaped == 'c')
+                        pos += 1;
+                    else if (escaped == 'x')
+                        pos += 2;
+                    else if (escaped == 'u')
+                        pos += 4;
+                }
+                else {
+                    tokens.push_back({TokenType::Literal, escaped});
+                }
+                break;
+            }
+            default:
+                tokens.push_back({TokenType::Literal, ch});
+                break;
+            }
+        }
+
+        return true;
+    }
+}
+
+std::vector<std::string> requiredWords(std::string_view pattern)
+{
+    std::vector<Token> tokens;
+    if (!tokenize(pattern, tokens))
+        return {};
+
+    std::vector<std::string> words;
+    std::vector<Token>::size_type pos = 0;
+
+    while (pos < tokens.size()) {
+        if ((tokens[pos].type != TokenType::Literal) || !isWordChar(tokens[pos].ch)) {
+            ++pos;
+            continue;
+        }
+
+        // Without a bound on both sides the title might contain the word inside a longer one
+        const bool leftBounded = (pos > 0) && isBound(tokens[pos - 1]);
+
+        std::string word;
+        while ((pos < tokens.size()) && (tokens[pos].type == TokenType::Literal) && isWordChar(tokens[pos].ch))
+            word += tokens[pos++].ch;
+
+        const bool rightBounded = (pos < tokens.size()) && isBound(tokens[pos]);
+
+        if (leftBounded && rightBounded && isSearchWord(word) && (std::find(words.cbegin(), words.cend(), word) == words.cend()))
+            words.push_back(word);
+    }
+
+    return words;
+}
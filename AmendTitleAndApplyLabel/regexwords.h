@@ -0,0 +1,36 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Returns the whole words that appear in every title matched by `pattern`
+// (ECMAScript grammar), eg "WIP" for "^\[WIP\]". A word counts only if the
+// pattern bounds it on both sides with whitespace, a bracket or similar
+// punctuation, because the search API matches whole words. Anchors and \b
+// aren't bounds, as the word might still be followed by eg '-'. The analysis is conservative:
+// groups, classes and quantified characters end a literal, and an alternation
+// outside of a group discards everything. Only ASCII letters and digits form words.
+std::vector<std::string> requiredWords(std::string_view pattern);
@@ -0,0 +1,130 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "postdownloader.h"
+
+#include "fakeserver.h"
+
+// Implements the PostDownloader of postdownloader.h without any I/O. A request is answered
+// by FakeServer::respond from run(), runSent() or a finished handler sending the next request.
+
+FakeServer &FakeServer::instance()
+{
+    static FakeServer server;
+    return server;
+}
+
+void FakeServer::reset()
+{
+    *this = FakeServer{};
+}
+
+PostDownloader::PostDownloader(const ProgramOptions &)
+    : m_ctx(boost::asio::ssl::context::tlsv12_client)
+    , m_resolver(m_ioc)
+    , m_timer(m_ioc)
+{
+}
+
+PostDownloader::~PostDownloader() = default;
+
+void PostDownloader::run()
+{
+    sendRequest();
+    runSent();
+}
+
+void PostDownloader::runSent()
+{
+    FakeServer &server = FakeServer::instance();
+
+    while (server.hasRequest) {
+        server.hasRequest = false;
+        const FakeReply reply = server.respond(server.requests.back());
+
+        m_response = {};
+        if (!reply.error.empty()) {
+            m_error = reply.error;
+        }
+        else {
+            m_response.result(reply.status);
+            m_response.body() = reply.body;
+            m_response.keep_alive(true);
+        }
+
+        if (m_finishedHanlder)
+            m_finishedHanlder();
+    }
+}
+
+std::string_view PostDownloader::error() const
+{
+    return m_error;
+}
+
+void PostDownloader::setFinishedHandler(FinishedHandler handler)
+{
+    m_finishedHanlder = handler;
+}
+
+void PostDownloader::setRequestBody(std::string_view body)
+{
+    m_body = body;
+}
+
+const http::response<http::string_body>& PostDownloader::response() const
+{
+    return m_response;
+}
+
+std::string PostDownloader::takeResponseBody()
+{
+    return std::move(m_response.body());
+}
+
+bool PostDownloader::isKeptAlive() const
+{
+    return m_response.keep_alive();
+}
+
+void PostDownloader::sendRequest()
+{
+    FakeServer &server = FakeServer::instance();
+    server.requests.push_back(m_body);
+    server.hasRequest = true;
+}
+
+void PostDownloader::sendRequestAfter(std::chrono::steady_clock::duration)
+{
+    sendRequest();
+}
+
+void PostDownloader::resendOnNewConnection()
+{
+    m_error.clear();
+    ++FakeServer::instance().newConnections;
+    sendRequest();
+}
+
+void PostDownloader::closeConnection()
+{
+}
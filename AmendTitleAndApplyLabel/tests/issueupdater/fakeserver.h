@@ -0,0 +1,52 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/beast/http/status.hpp>
+
+// The answer of the fake PostDownloader to one request
+struct FakeReply {
+    // A transport error, eg a timeout. The status and body are ignored if set.
+    std::string error;
+    boost::beast::http::status status = boost::beast::http::status::ok;
+    std::string body;
+};
+
+// Stands in for GitHub in the tests. fakepostdownloader.cpp replaces postdownloader.cpp,
+// so the classes under test talk to this instead of the network.
+struct FakeServer {
+    static FakeServer &instance();
+    void reset();
+
+    // Called with the body of each request
+    std::function<FakeReply (std::string_view request)> respond;
+    // The bodies of the requests, in the order they were sent
+    std::vector<std::string> requests;
+    int newConnections = 0;
+    bool hasRequest = false;
+};
@@ -0,0 +1,232 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <iostream>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "fakeserver.h"
+#include "issueattributes.h"
+#include "issueupdater.h"
+#include "postdownloader.h"
+#include "programoptions.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    using IssueMap = std::unordered_map<std::vector<int>::size_type, std::vector<IssueAttributes>>;
+
+    constexpr int ISSUES = 3;
+    const std::string ORIGINAL_TITLE = "WIP: Crash on start";
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    IssueMap makeIssues()
+    {
+        IssueMap issues;
+        for (int i = 0; i < ISSUES; ++i) {
+            issues[0].emplace_back("ISSUE_" + std::to_string(i), i + 1, "Crash on start", ORIGINAL_TITLE);
+            issues[0].back().labelID = "LABEL_0";
+        }
+
+        return issues;
+    }
+
+    bool isMutation(std::string_view request)
+    {
+        return json::parse(request)["query"].get<std::string>().rfind("mutation", 0) == 0;
+    }
+
+    std::vector<std::string> mutations()
+    {
+        std::vector<std::string> requests;
+        for (const std::string &request : FakeServer::instance().requests) {
+            if (isMutation(request))
+                requests.push_back(request);
+        }
+
+        return requests;
+    }
+
+    // The issues are unchanged since they were gathered and every mutation succeeds
+    FakeReply answer(std::string_view request)
+    {
+        const json body = json::parse(request);
+        json data = json::object();
+
+        if (!isMutation(request)) {
+            data["nodes"] = json::array();
+            for (const auto &id : body["variables"]["ids"])
+                data["nodes"].push_back({{"id", id}, {"state", "OPEN"}, {"title", ORIGINAL_TITLE}});
+        }
+        else {
+            static const std::regex alias{R"((\w+): \w+\(input)"};
+            const std::string query = body["query"].get<std::string>();
+            for (std::sregex_iterator iter{query.cbegin(), query.cend(), alias}, end; iter != end; ++iter)
+                data[(*iter)[1].str()] = {{"clientMutationId", nullptr}};
+        }
+
+        return {{}, boost::beast::http::status::ok, json{{"data", data}}.dump()};
+    }
+
+    // The first mutation request fails with `failure` and the rest are answered
+    void failFirstMutation(const FakeReply &failure)
+    {
+        FakeServer::instance().reset();
+        FakeServer::instance().respond = [failure, failed = false](std::string_view request) mutable
+        {
+            if (failed || !isMutation(request))
+                return answer(request);
+
+            failed = true;
+            return failure;
+        };
+    }
+
+    std::string runUpdater(const IssueMap &issues)
+    {
+        std::string error;
+        PostDownloader downloader{ProgramOptions{}};
+        IssueUpdater updater{downloader, issues, error};
+        updater.run();
+        return error;
+    }
+
+    // What GitHub answers when a query runs out of time
+    const json TIMEOUT_ERROR = {{"message", "Something went wrong while executing your query. This may be the result of a timeout, "
+                                            "or it could be a GitHub bug. Please include `0400:3E5B:1A2B3C:4D5E6F:5F4E3D2C` when reporting this issue."}};
+
+    FakeReply graphQLError(const json &error)
+    {
+        return {{}, boost::beast::http::status::ok, json{{"errors", json::array({error})}}.dump()};
+    }
+
+    void testTimeoutResendsBatch()
+    {
+        const IssueMap issues = makeIssues();
+        failFirstMutation({"Failed read: The socket was closed due to a timeout", {}, {}});
+
+        const std::string error = runUpdater(issues);
+        const std::vector<std::string> sent = mutations();
+
+        check(error.empty(), "a timed out batch is retried, got: " + error);
+        check(sent.size() == 2, "the timed out batch is sent again");
+        check(FakeServer::instance().newConnections == 1, "the batch is sent again on a new connection");
+        for (const IssueAttributes &issue : issues.at(0))
+            check((sent.size() == 2) && (sent[1].find(issue.ID) != std::string::npos), issue.ID + " is in the resent batch");
+    }
+
+    void testGatewayTimeoutResendsBatch()
+    {
+        const IssueMap issues = makeIssues();
+        failFirstMutation({{}, boost::beast::http::status::gateway_timeout, {}});
+
+        const std::string error = runUpdater(issues);
+
+        check(error.empty(), "a batch answered with 504 is retried, got: " + error);
+        check(mutations().size() == 2, "the batch answered with 504 is sent again");
+    }
+
+    void testRepeatedTimeoutsAreReported()
+    {
+        const IssueMap issues = makeIssues();
+        FakeServer::instance().reset();
+        FakeServer::instance().respond = [](std::string_view request)
+        {
+            if (!isMutation(request))
+                return answer(request);
+
+            return FakeReply{"Failed read: The socket was closed due to a timeout", {}, {}};
+        };
+
+        const std::string error = runUpdater(issues);
+
+        check(!error.empty(), "a batch that keeps timing out is reported");
+    }
+
+    void testQueryTimeoutResendsBatch()
+    {
+        const IssueMap issues = makeIssues();
+        failFirstMutation(graphQLError(TIMEOUT_ERROR));
+
+        const std::string error = runUpdater(issues);
+
+        check(error.empty(), "a batch whose query timed out is retried, got: " + error);
+        check(mutations().size() == 2, "the batch whose query timed out is sent again");
+    }
+
+    void testExpensiveBatchIsResent()
+    {
+        const IssueMap issues = makeIssues();
+        failFirstMutation(graphQLError({{"type", "RESOURCE_LIMITS_EXCEEDED"}, {"message", "Resource limits for this query exceeded"}}));
+
+        const std::string error = runUpdater(issues);
+
+        check(error.empty(), "a rejected batch is retried, got: " + error);
+        check(mutations().size() == 2, "a rejected batch is sent again");
+    }
+
+    // Only the type and the start of the message classify an error, not the words in it
+    void testOtherErrorIsReported()
+    {
+        const IssueMap issues = makeIssues();
+        failFirstMutation(graphQLError({{"type", "FORBIDDEN"}, {"path", {"timeout0"}},
+                                        {"message", "Resource not accessible: timeout, complexity, MAX_NODE_LIMIT_EXCEEDED"}}));
+
+        const std::string error = runUpdater(issues);
+
+        check(!error.empty(), "a batch with another error is reported");
+        check(mutations().size() == 1, "a batch with another error isn't sent again");
+    }
+}
+
+int main()
+{
+    testTimeoutResendsBatch();
+    testGatewayTimeoutResendsBatch();
+    testQueryTimeoutResendsBatch();
+    testRepeatedTimeoutsAreReported();
+    testExpensiveBatchIsResent();
+    testOtherErrorIsReported();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
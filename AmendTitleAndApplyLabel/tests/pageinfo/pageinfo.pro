@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks that scanPageInfo() finds the cursor of the next page in the raw response
+TARGET = tst_pageinfo
+
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_pageinfo.cpp \
+           ../../pageinfo.cpp
@@ -0,0 +1,132 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pageinfo.h"
+
+namespace
+{
+    struct Case {
+        std::string_view name;
+        std::string_view response;
+        bool isForward;
+        // Empty if scanPageInfo() must give up
+        std::optional<PageInfo> expected;
+    };
+
+    const std::vector<Case> CASES = {
+        {"forward page",
+         R"({"data":{"repository":{"issues":{"nodes":[{"id":"I1","title":"Crash"}],"pageInfo":{"endCursor":"Y3Vyc29yOjE=","hasNextPage":true}}}}})",
+         true, PageInfo{"Y3Vyc29yOjE=", true}},
+        {"backward page",
+         R"({"data":{"repository":{"issues":{"nodes":[{"id":"I1","title":"Crash"}],"pageInfo":{"startCursor":"Y3Vyc29yOjE=","hasPreviousPage":true}}}}})",
+         false, PageInfo{"Y3Vyc29yOjE=", true}},
+        {"both cursors, forward",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"startCursor":"c3RhcnQ=","endCursor":"ZW5k","hasPreviousPage":false,"hasNextPage":true}}}}})",
+         true, PageInfo{"ZW5k", true}},
+        {"both cursors, backward",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"startCursor":"c3RhcnQ=","endCursor":"ZW5k","hasPreviousPage":false,"hasNextPage":true}}}}})",
+         false, PageInfo{"c3RhcnQ=", false}},
+        {"title with a pageInfo key",
+         R"({"data":{"repository":{"issues":{"nodes":[{"id":"I1","title":"\"pageInfo\":{\"endCursor\":\"ZmFrZQ==\",\"hasNextPage\":false}"}],)"
+         R"("pageInfo":{"endCursor":"cmVhbA==","hasNextPage":true}}}}})",
+         true, PageInfo{"cmVhbA==", true}},
+        {"title with a pageInfo key and no real pageInfo",
+         R"({"data":{"repository":{"issues":{"nodes":[{"id":"I1","title":"\"pageInfo\":{\"endCursor\":\"ZmFrZQ==\",\"hasNextPage\":true}"}]}}}})",
+         true, std::nullopt},
+        {"null cursor",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"endCursor":null,"hasNextPage":false}}}}})",
+         true, PageInfo{"", false}},
+        {"last page",
+         R"({"data":{"repository":{"issues":{"nodes":[{"id":"I1","title":"Crash"}],"pageInfo":{"endCursor":"Y3Vyc29yOjE=","hasNextPage":false}}}}})",
+         true, PageInfo{"Y3Vyc29yOjE=", false}},
+        {"non-compact body",
+         "{\n  \"data\": {\n    \"repository\": {\n      \"issues\": {\n        \"nodes\": [],\n"
+         "        \"pageInfo\": {\n          \"endCursor\": \"Y3Vyc29yOjE=\",\n          \"hasNextPage\": true\n        }\n      }\n    }\n  }\n}",
+         true, std::nullopt},
+        {"spaces inside pageInfo",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"endCursor": "Y3Vyc29yOjE=", "hasNextPage": true}}}}})",
+         true, std::nullopt},
+        {"escaped cursor",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"endCursor":"Y3Vyc\u0032","hasNextPage":true}}}}})",
+         true, std::nullopt},
+        {"unexpected hasNextPage",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"endCursor":"Y3Vyc29yOjE=","hasNextPage":null}}}}})",
+         true, std::nullopt},
+        {"missing hasNextPage",
+         R"({"data":{"repository":{"issues":{"nodes":[],"pageInfo":{"endCursor":"Y3Vyc29yOjE="}}}}})",
+         true, std::nullopt},
+        {"error response",
+         R"({"errors":[{"message":"timeout","type":"timeout"}],"data":null})",
+         true, std::nullopt},
+    };
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    std::string describe(const std::optional<PageInfo> &pageInfo)
+    {
+        if (!pageInfo)
+            return "nullopt";
+
+        return "{\"" + pageInfo->cursor + "\", " + (pageInfo->hasNext ? "true" : "false") + "}";
+    }
+
+    void testCases()
+    {
+        for (const Case &c : CASES) {
+            const std::optional<PageInfo> actual = c.isForward
+                    ? scanPageInfo(c.response, "endCursor", "hasNextPage")
+                    : scanPageInfo(c.response, "startCursor", "hasPreviousPage");
+
+            const bool isSame = (actual.has_value() == c.expected.has_value())
+                    && (!actual || ((actual->cursor == c.expected->cursor) && (actual->hasNext == c.expected->hasNext)));
+            check(isSame, std::string(c.name) + ": expected " + describe(c.expected) + ", got " + describe(actual));
+        }
+    }
+}
+
+int main()
+{
+    testCases();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,12 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks the words that requiredWords() takes out of the title regexes
+TARGET = tst_regexwords
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_regexwords.cpp \
+           ../../regexwords.cpp
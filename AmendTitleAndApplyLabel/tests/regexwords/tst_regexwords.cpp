@@ -0,0 +1,145 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "regexwords.h"
+
+namespace
+{
+    struct Case {
+        std::string_view pattern;
+        std::vector<std::string> expected;
+    };
+
+    // A word that isn't in every matched title makes the search miss issues,
+    // so every doubtful pattern must give no words
+    const std::vector<Case> CASES = {
+        {R"(^\[WIP\])", {"WIP"}},
+        {R"(\[WIP\])", {"WIP"}},
+        {R"(\(bug\))", {"bug"}},
+        {R"(^\[WIP\]\s)", {"WIP"}},
+        {R"(\[WIP\] \[WIP\])", {"WIP"}},
+        {R"(\[WIP\] \[Draft 2\]:)", {"WIP", "Draft", "2"}},
+        {R"(\[WIP\]+)", {"WIP"}},
+        {R"(\[WIP\]\t)", {"WIP"}},
+
+        // Not bounded by a separator on both sides
+        {R"(\bWIP\b)", {}},
+        {R"(^WIP$)", {}},
+        {R"(bug)", {}},
+        {R"(\[WIP)", {}},
+        {R"(\[WIP-2\])", {}},
+        {R"(\[v1\.2\])", {}},
+        {R"([x]WIP\])", {}},
+        {R"(\[WIP[x])", {}},
+        {R"(.WIP\])", {}},
+
+        // Quantified bounds might be missing
+        {R"(\[WIP\]?)", {}},
+        {R"(\[WIP\]*)", {}},
+        {R"(\[WIP\]{0,1})", {}},
+        {R"(\[?WIP\])", {}},
+        {R"(\[WIPS?\])", {}},
+
+        // Alternations, groups and classes
+        {R"(a|b)", {}},
+        {R"(\[WIP\]|\[Draft\])", {}},
+        {R"((\[WIP\]))", {}},
+        {R"((?:\[WIP\]))", {}},
+        {R"([\[]WIP[\]])", {}},
+        {R"([]\[]WIP\])", {}},
+        {R"(\[(WIP|Draft)\])", {}},
+        {R"((a|b) \[WIP\])", {"WIP"}},
+
+        // Character codes, classes and back references aren't literals
+        {R"(\[\x41\])", {}},
+        {R"(\[\u0041\])", {}},
+        {R"(\[A\x42\])", {}},
+        {R"(\[\u0041B\])", {}},
+        {R"(\[\cA\])", {}},
+        {R"(\[\w+\])", {}},
+        {R"(\[\d\])", {}},
+        {R"((a)\[\1\])", {}},
+        {R"(\[\x41\] \[WIP\])", {"WIP"}},
+
+        // Only ASCII letters and digits form search words
+        {"\\[caf\xC3\xA9\\]", {}},
+        {"\\[\xE6\x97\xA5\xE6\x9C\xAC\\]", {}},
+        {"\\[\xC3\xBC" "ber\\]", {}},
+        {"\\[WIP\\] \\[\xC3\xA9t\xC3\xA9\\]", {"WIP"}},
+        {R"(\[WIP_2\])", {}},
+
+        // Incomplete patterns
+        {R"()", {}},
+        {R"(\)", {}},
+        {R"(\[WIP\)", {}},
+    };
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    std::string describe(const std::vector<std::string> &words)
+    {
+        std::string text = "{";
+        for (const std::string &word : words) {
+            if (text.size() > 1)
+                text += ", ";
+            text += '"' + word + '"';
+        }
+        text += '}';
+
+        return text;
+    }
+
+    void testCases()
+    {
+        for (const Case &c : CASES) {
+            const std::vector<std::string> actual = requiredWords(c.pattern);
+            check(actual == c.expected, std::string(c.pattern) + ": expected " + describe(c.expected) + ", got " + describe(actual));
+        }
+    }
+}
+
+int main()
+{
+    testCases();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
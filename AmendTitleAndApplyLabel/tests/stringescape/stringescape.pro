@@ -0,0 +1,15 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks that appendEscaped() escapes like json::dump() and times it against the old per-character loop.
+# This builds the SSE2 path and stringescapeavx2 builds the AVX2 one.
+TARGET = tst_stringescape
+
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_stringescape.cpp \
+           ../../stringescape.cpp
@@ -0,0 +1,15 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# The test of stringescape, built for the AVX2 path of appendEscaped()
+TARGET = tst_stringescapeavx2
+
+QMAKE_CXXFLAGS += -mavx2
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+INCLUDEPATH += ../..
+
+SOURCES += ../stringescape/tst_stringescape.cpp \
+           ../../stringescape.cpp
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+# Run with "make check"
+SUBDIRS = issueupdater \
+          pageinfo \
+          regexwords \
+          stringescape \
+          stringescapeavx2
@@ -16,17 +16,50 @@ LIBS += $$quote(-LG:/QBITTORRENT/install_mingw/base/lib)
 LIBS += libboost_program_options-mgw9-mt-s-x64-1_74
 LIBS += -lssl -lcrypto -lz -lgdi32 -luser32 -lws2_32 -ladvapi32 -lcrypt32
 
-HEADERS += issuegatherer.h \
+# Parses the issue, label and mutation responses with simdjson: qmake "CONFIG+=simdjson"
+simdjson {
+    DEFINES += USE_SIMDJSON
+    LIBS += -lsimdjson
+}
+
+HEADERS += batchsizer.h \
+           bootstrapquery.h \
+           connectionreader.h \
+           executionplanner.h \
+           graphqlrequest.h \
+           issueattributes.h \
+           issuegatherer.h \
+           issueshardplanner.h \
            issueupdater.h \
+           jsonbackend.h \
+           jsonpushparser.h \
            labelcreator.h \
            labelgatherer.h \
+           labelprojection.h \
+           labeltable.h \
+           mutationqueue.h \
+           mutationresult.h \
            postdownloader.h \
-           programoptions.h
+           programoptions.h \
+           querycost.h \
+           querytemplate.h \
+           stringescape.h
 
 SOURCES += main.cpp \
+           batchsizer.cpp \
+           bootstrapquery.cpp \
+           executionplanner.cpp \
+           graphqlrequest.cpp \
            issuegatherer.cpp \
+           issueshardplanner.cpp \
            issueupdater.cpp \
            labelcreator.cpp \
            labelgatherer.cpp \
+           labelprojection.cpp \
+           labeltable.cpp \
+           mutationqueue.cpp \
+           mutationresult.cpp \
            postdownloader.cpp \
-           programoptions.cpp
+           programoptions.cpp \
+           querycost.cpp \
+           stringescape.cpp
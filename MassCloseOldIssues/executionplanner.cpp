@@ -0,0 +1,276 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "executionplanner.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <nlohmann/json.hpp>
+
+#include "bootstrapquery.h"
+#include "issuegatherer.h"
+#include "issueupdater.h"
+#include "labelgatherer.h"
+#include "postdownloader.h"
+#include "programoptions.h"
+#include "querycost.h"
+#include "querytemplate.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    constexpr long long PAGE_SIZE = 100;
+    // The search API returns at most this many results for a query
+    constexpr long long SEARCH_RESULTS_LIMIT = 1000;
+    // A mutation costs 1 point of the primary rate limit
+    constexpr long long MUTATION_POINTS = 1;
+    // Requests with mutations cost 5 points of the secondary rate limit,
+    // which allows 2000 points per minute
+    constexpr long long SECONDARY_MUTATION_POINTS = 5;
+    constexpr long long SECONDARY_POINTS_PER_MINUTE = 2000;
+    // GitHub allows about 80 content creating requests, like comments, per minute
+    constexpr long long COMMENTS_PER_MINUTE = 80;
+    // Rough server time of one mutation inside a batch
+    constexpr std::chrono::milliseconds MUTATION_TIME{150};
+    // Left unused, for the other tools sharing the token
+    constexpr long long RESERVED_POINTS = 10;
+
+    // The probe is part of the bootstrap query, so the fields are aliased when they might conflict
+    constexpr QueryTemplate PROBE_FIELDS{"rateLimit { limit remaining resetAt } "
+                                         "candidates: search(query:$candidates, type:ISSUE) { issueCount }"};
+    static_assert(PROBE_FIELDS.isBalanced(), "Unbalanced GraphQL query");
+    constexpr QueryTemplate PROBE_REPOSITORY_FIELDS{"openIssues: issues(states:OPEN) { totalCount } labels { totalCount }"};
+    static_assert(PROBE_REPOSITORY_FIELDS.isBalanced(), "Unbalanced GraphQL query");
+
+    long long pages(long long items)
+    {
+        return std::max(1LL, (items + PAGE_SIZE - 1) / PAGE_SIZE);
+    }
+}
+
+ExecutionPlanner::ExecutionPlanner(const ProgramOptions &programOptions, PostDownloader &downloader,
+                                   BootstrapQuery &bootstrap, std::string &error)
+    : m_programOptions(programOptions)
+    , m_downloader(downloader)
+    , m_bootstrap(bootstrap)
+    , m_error(error)
+{
+    m_error.clear();
+}
+
+void ExecutionPlanner::run()
+{
+    m_downloader.setFinishedHandler(beast::bind_front_handler(&ExecutionPlanner::onFinishedPage, this));
+    m_bootstrap.addVariable("$candidates: String!", IssueGatherer::searchQuery(m_programOptions));
+    m_bootstrap.addFields(PROBE_FIELDS.text());
+    m_bootstrap.addRepositoryFields(PROBE_REPOSITORY_FIELDS.text());
+
+    m_downloader.setRequestBody(m_bootstrap.body());
+    m_probeSentTime = std::chrono::steady_clock::now();
+    m_downloader.run();
+    m_downloader.setFinishedHandler(FinishedHandler{});
+
+    if (!m_error.empty())
+        return;
+
+    printPlan();
+
+    const long long needed = gatherPhase().points + labelPhase().points + RESERVED_POINTS;
+    if (needed > m_remainingPoints) {
+        m_error = "Gathering the issues needs about " + std::to_string(needed) + " points but only "
+                + std::to_string(m_remainingPoints) + " remain until " + m_resetAt + ". Try again later.";
+    }
+}
+
+std::size_t ExecutionPlanner::planUpdates(std::size_t issues) const
+{
+    const long long available = m_remainingPoints - gatherPhase().points - labelPhase().points - RESERVED_POINTS;
+    if (updatePhase(issues).points <= available)
+        return issues;
+
+    // The most issues whose batches and revalidation queries fit. The cost grows with the issues,
+    // so it is bisected. Every batch holds at least the initial number of issues.
+    std::size_t fitting = 0;
+    std::size_t tooMany = issues;
+    while (tooMany - fitting > 1) {
+        const std::size_t middle = fitting + (tooMany - fitting) / 2;
+        if (updatePhase(middle).points <= available)
+            fitting = middle;
+        else
+            tooMany = middle;
+    }
+
+    std::cout << "Only " << fitting << " of the " << issues << " issues fit in the remaining rate limit points. "
+              << "Run again after " << m_resetAt << " for the rest." << std::endl;
+
+    return fitting;
+}
+
+void ExecutionPlanner::onFinishedPage()
+{
+    m_latency = std::chrono::steady_clock::now() - m_probeSentTime;
+
+    if (!m_downloader.error().empty()) {
+        m_error = m_downloader.error();
+        return;
+    }
+
+    if (m_downloader.response().base().result() != http::status::ok) {
+        m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
+        return;
+    }
+
+    m_bootstrapResponse = m_downloader.response().body();
+    gatherProbe(m_bootstrapResponse);
+}
+
+void ExecutionPlanner::gatherProbe(std::string_view response)
+{
+    try {
+        const json data = json::parse(response);
+        // The label lookup and the first issue page share this response. None of them reports an expected
+        // outcome as an error, eg a missing label is "label": null, so any error stops the run.
+        if (data.contains("errors")) {
+            m_error = "The last API call returned an error:\n" + data.dump();
+            return;
+        }
+
+        const json &rateLimit = data["data"]["rateLimit"];
+        m_remainingPoints = rateLimit["remaining"].get<long long>();
+        m_pointsLimit = rateLimit["limit"].get<long long>();
+        m_resetAt = rateLimit["resetAt"].get<std::string>();
+
+        const json &repository = data["data"]["repository"];
+        m_openIssues = repository["openIssues"]["totalCount"].get<int>();
+        m_labels = repository["labels"]["totalCount"].get<int>();
+        m_candidates = data["data"]["candidates"]["issueCount"].get<int>();
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+void ExecutionPlanner::printPlan()
+{
+    const Phase gather = gatherPhase();
+    const Phase labels = labelPhase();
+    const Phase update = updatePhase(m_candidates);
+    const Phase queries{gather.requests + labels.requests, gather.points + labels.points};
+    const long long totalPoints = queries.points + update.points;
+
+    std::cout << "Execution plan for " << m_candidates << " of " << m_openIssues << " open issues:\n"
+              << "  Gather issues:  " << gather.requests << " requests, " << gather.points << " points\n";
+    if (!m_programOptions.applyLabel.empty()) {
+        const Phase labelScan = labelScanPhase();
+        std::cout << "  Create label:   " << labels.requests << " requests, " << labels.points << " points\n"
+                  << "  Label fallback: " << labelScan.requests << " requests, " << labelScan.points
+                  << " points, only if the lookup fails\n";
+    }
+    std::cout << "  Update issues:  " << update.requests << " requests, " << update.points << " points\n"
+              << "  Total:          " << totalPoints << " points of " << m_remainingPoints << "/" << m_pointsLimit
+              << " remaining until " << m_resetAt << "\n"
+              << "  Estimated time: " << estimateTime(queries, m_candidates).count() << " s" << std::endl;
+}
+
+ExecutionPlanner::Phase ExecutionPlanner::gatherPhase() const
+{
+    const long long pagePoints = estimateQueryCost(IssueGatherer::queryDocument(m_programOptions)).points();
+    Phase phase;
+
+    if (m_programOptions.useSearch) {
+        // Each restart past the search limit repeats the last page
+        phase.requests = pages(m_candidates) + (m_candidates / SEARCH_RESULTS_LIMIT);
+        // Bounds and counts of the shards
+        if (m_programOptions.shards > 1)
+            phase.requests += 2 + m_programOptions.shards;
+    }
+    else {
+        // The issues are paginated by creation date until the cutoff date
+        phase.requests = pages(m_openIssues);
+    }
+
+    phase.points = phase.requests * pagePoints;
+    return phase;
+}
+
+ExecutionPlanner::Phase ExecutionPlanner::labelPhase() const
+{
+    if (m_programOptions.applyLabel.empty())
+        return {};
+
+    // The label is looked up by name with the bootstrap query, whose cost is already spent.
+    // A missing one is null in that response and is created.
+    Phase phase;
+    phase.requests = 1;
+    phase.points = MUTATION_POINTS;
+    return phase;
+}
+
+// All the labels are scanned only when the lookup response can't be used, so it isn't budgeted
+ExecutionPlanner::Phase ExecutionPlanner::labelScanPhase() const
+{
+    if (m_programOptions.applyLabel.empty())
+        return {};
+
+    const long long pagePoints = estimateQueryCost(LabelGatherer::queryDocument()).points();
+    Phase phase;
+    phase.requests = pages(m_labels);
+    phase.points = phase.requests * pagePoints;
+    return phase;
+}
+
+ExecutionPlanner::Phase ExecutionPlanner::updatePhase(std::size_t issues) const
+{
+    const long long batchSize = IssueUpdater::initialBatchSize();
+    Phase phase;
+    phase.requests = (static_cast<long long>(issues) + batchSize - 1) / batchSize;
+    phase.points = phase.requests * MUTATION_POINTS;
+
+    // The upcoming issues are revalidated with one query per page of them
+    if (issues > 0) {
+        phase.requests += pages(static_cast<long long>(issues));
+        phase.points += pages(static_cast<long long>(issues));
+    }
+    return phase;
+}
+
+std::chrono::seconds ExecutionPlanner::estimateTime(const Phase &queries, std::size_t issues) const
+{
+    const Phase update = updatePhase(issues);
+    const long long mutations = static_cast<long long>(issues) * IssueUpdater::mutationsPerIssue(m_programOptions);
+    const auto busyTime = ((queries.requests + update.requests) * m_latency) + (mutations * MUTATION_TIME);
+
+    // The secondary rate limits can't be exceeded no matter how fast GitHub responds
+    long long minimumMinutes = (update.requests * SECONDARY_MUTATION_POINTS) / SECONDARY_POINTS_PER_MINUTE;
+    if (!m_programOptions.comment.empty())
+        minimumMinutes = std::max(minimumMinutes, static_cast<long long>(issues) / COMMENTS_PER_MINUTE);
+
+    return std::max(std::chrono::ceil<std::chrono::seconds>(busyTime), std::chrono::seconds(std::chrono::minutes(minimumMinutes)));
+}
+
+std::string_view ExecutionPlanner::bootstrapResponse() const
+{
+    return m_bootstrapResponse;
+}
@@ -0,0 +1,84 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class BootstrapQuery;
+class ProgramOptions;
+class PostDownloader;
+
+// Estimates the requests, rate limit points and time a run needs, from the
+// cost of the GraphQL documents and a cheap probe of the issue counts.
+// The probe is sent as part of the bootstrap query.
+// The estimates are upper bounds: the gatherer may stop early at the cutoff date.
+class ExecutionPlanner
+{
+public:
+    // The passed arguments must outlive the class instance
+    explicit ExecutionPlanner(const ProgramOptions &programOptions, PostDownloader &downloader,
+                              BootstrapQuery &bootstrap, std::string &error);
+
+    // Sends the bootstrap query with the probe of the rate limit and the issue counts, then prints the plan.
+    // Fails if gathering the issues alone would exhaust the remaining points.
+    void run();
+    // Returns how many of the gathered issues can be updated with the points
+    // left after the gather. The rest must wait for the next run.
+    std::size_t planUpdates(std::size_t issues) const;
+    // The other parts of the bootstrap query parse their fields from it
+    std::string_view bootstrapResponse() const;
+
+private:
+    struct Phase {
+        long long requests = 0;
+        long long points = 0;
+    };
+
+    void onFinishedPage();
+
+    void gatherProbe(std::string_view response);
+    void printPlan();
+    Phase gatherPhase() const;
+    Phase labelPhase() const;
+    Phase labelScanPhase() const;
+    Phase updatePhase(std::size_t issues) const;
+    std::chrono::seconds estimateTime(const Phase &queries, std::size_t issues) const;
+
+    const ProgramOptions &m_programOptions;
+    PostDownloader &m_downloader;
+    BootstrapQuery &m_bootstrap;
+    std::string &m_error;
+
+    std::string m_bootstrapResponse;
+    std::chrono::steady_clock::time_point m_probeSentTime;
+    std::chrono::steady_clock::duration m_latency{};
+    long long m_remainingPoints = 0;
+    long long m_pointsLimit = 0;
+    std::string m_resetAt;
+    int m_openIssues = 0;
+    int m_candidates = 0;
+    int m_labels = 0;
+};
@@ -0,0 +1,54 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "graphqlrequest.h"
+
+GraphQLRequest::GraphQLRequest(std::string_view document, const json &constantVariables)
+    : m_hasConstantVariables(!constantVariables.empty())
+{
+    json req;
+    req["query"] = document;
+    req["variables"] = constantVariables.empty() ? json::object() : constantVariables;
+
+    // The keys of a json object are sorted so `variables` is always serialized last:
+    // {"query":"...","variables":{...}}
+    m_head = req.dump();
+    m_head.resize(m_head.size() - 2);
+}
+
+std::string GraphQLRequest::body(const json &variables) const
+{
+    if (variables.empty())
+        return m_head + "}}";
+
+    // Skip the opening brace of the object, its closing brace is reused
+    const std::string serialized = variables.dump();
+    std::string body;
+    body.reserve(m_head.size() + serialized.size() + 2);
+    body += m_head;
+    if (m_hasConstantVariables)
+        body += ',';
+    body.append(serialized, 1, std::string::npos);
+    body += '}';
+
+    return body;
+}
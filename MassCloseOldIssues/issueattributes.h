@@ -0,0 +1,48 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "labeltable.h"
+
+struct IssueAttributes {
+    std::string ID;
+    // All the label IDs of the issue. Empty if the labels weren't gathered.
+    std::optional<LabelHandles> labelIDs;
+    // The label to apply, of the repo of the issue. Known once the labels are gathered or created.
+    LabelHandle labelID = NO_LABEL;
+
+    explicit IssueAttributes(std::string_view id)
+        : ID(id)
+    {
+    }
+
+    IssueAttributes(std::string_view id, LabelHandles &&labels)
+        : ID(id)
+        , labelIDs(std::move(labels))
+    {
+    }
+};
@@ -22,49 +22,237 @@ SOFTWARE. */
 
 #include "issuegatherer.h"
 
+#include <algorithm>
+#include <charconv>
 #include <iostream>
 
-#include <boost/algorithm/string/predicate.hpp>
-
 #include "HowardHinnant/date.h"
 
+#include "bootstrapquery.h"
+#include "connectionreader.h"
+#include "issueattributes.h"
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
 
 namespace {
     using timePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds>;
-    bool parseISOTimePoint(const std::string &timepoint, timePoint &tp)
+
+    // Reads the digits of `text` at [pos, pos + count)
+    bool parseDigits(std::string_view text, std::size_t pos, std::size_t count, int &value)
+    {
+        const char *end = text.data() + pos + count;
+        const auto result = std::from_chars(text.data() + pos, end, value);
+        return (result.ec == std::errc{}) && (result.ptr == end) && (text[pos] != '-') && (text[pos] != '+');
+    }
+
+    bool parseISOTimePoint(std::string_view timepoint, timePoint &tp)
     {
-        std::istringstream in{timepoint};
+        // GitHub sends "YYYY-MM-DDTHH:MM:SSZ", which is read without a stream
+        int year, month, day, hours, minutes, seconds;
+        if ((timepoint.size() == 20) && (timepoint[4] == '-') && (timepoint[7] == '-') && (timepoint[10] == 'T')
+                && (timepoint[13] == ':') && (timepoint[16] == ':') && (timepoint[19] == 'Z')
+                && parseDigits(timepoint, 0, 4, year) && parseDigits(timepoint, 5, 2, month) && parseDigits(timepoint, 8, 2, day)
+                && parseDigits(timepoint, 11, 2, hours) && parseDigits(timepoint, 14, 2, minutes) && parseDigits(timepoint, 17, 2, seconds)) {
+            const date::year_month_day ymd{date::year{year}, date::month(month), date::day(day)};
+            if (ymd.ok() && (hours < 24) && (minutes < 60) && (seconds < 60)) {
+                tp = date::sys_days{ymd} + std::chrono::hours{hours} + std::chrono::minutes{minutes} + std::chrono::seconds{seconds};
+                return true;
+            }
+        }
+
+        std::istringstream in{std::string(timepoint)};
         in >> date::parse("%FT%TZ", tp);
         return !in.fail();
     }
 
+    // The transient data of a page fit in this, so usually the page arena doesn't allocate
+    constexpr std::size_t PAGE_ARENA_SIZE = 128 * 1024;
+
+    // $labels comes from a LabelProjection. The issues with more labels are completed by ISSUE_LABELS_QUERY.
+    constexpr QueryTemplate ISSUES_FIELDS{"issues(first:100, after:$after, states:OPEN, orderBy:{field:CREATED_AT, direction:ASC}) { "
+                                          "nodes { id createdAt updatedAt labels(first:$labels){ totalCount nodes { id name } } } pageInfo { endCursor hasNextPage } }"};
+    constexpr auto ISSUES_QUERY = QueryTemplate{"query($owner: String!, $name: String!, $after: String, $labels: Int!) { "
+                                                "repository(owner:$owner, name:$name) { "} + ISSUES_FIELDS + QueryTemplate{" } }"};
+    static_assert(ISSUES_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    // Without labels to skip or apply, the labels of the issues aren't needed at all.
+    // labels(first:) only accepts 1 to 100, so the selection is left out instead of asking for 0.
+    constexpr QueryTemplate UNLABELED_ISSUES_FIELDS{"issues(first:100, after:$after, states:OPEN, orderBy:{field:CREATED_AT, direction:ASC}) { "
+                                                    "nodes { id createdAt updatedAt } pageInfo { endCursor hasNextPage } }"};
+    constexpr auto UNLABELED_ISSUES_QUERY = QueryTemplate{"query($owner: String!, $name: String!, $after: String) { "
+                                                          "repository(owner:$owner, name:$name) { "} + UNLABELED_ISSUES_FIELDS + QueryTemplate{" } }"};
+    static_assert(UNLABELED_ISSUES_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate ISSUE_LABELS_QUERY{"query($ids: [ID!]!) { "
+                                               "nodes(ids:$ids) { ... on Issue { id labels(first:100){ nodes { id name } } } } }"};
+    static_assert(ISSUE_LABELS_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    // nodes(ids:) accepts at most 100 IDs
+    constexpr int MAX_NODE_IDS = 100;
+
+    // The skip labels are also checked here, since not every name can be excluded by the search qualifiers
+    constexpr QueryTemplate SEARCH_FIELDS{"search(query:$query, type:ISSUE, first:100, after:$after) { "
+                                          "issueCount nodes { ... on Issue { id createdAt updatedAt labels(first:$labels){ totalCount nodes { id name } } } } "
+                                          "pageInfo { endCursor hasNextPage } }"};
+    constexpr auto SEARCH_QUERY = QueryTemplate{"query($query: String!, $after: String, $labels: Int!) { "} + SEARCH_FIELDS + QueryTemplate{" }"};
+    static_assert(SEARCH_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate UNLABELED_SEARCH_FIELDS{"search(query:$query, type:ISSUE, first:100, after:$after) { "
+                                                    "issueCount nodes { ... on Issue { id createdAt updatedAt } } pageInfo { endCursor hasNextPage } }"};
+    constexpr auto UNLABELED_SEARCH_QUERY = QueryTemplate{"query($query: String!, $after: String) { "} + UNLABELED_SEARCH_FIELDS + QueryTemplate{" }"};
+    static_assert(UNLABELED_SEARCH_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    // The search API returns at most this many results for a query
+    constexpr int SEARCH_RESULTS_LIMIT = 1000;
+
+    bool needsLabels(const ProgramOptions &programOptions)
+    {
+        return !programOptions.labelList.empty() || !programOptions.applyLabel.empty();
+    }
+
+    std::string_view issuesQuery(const ProgramOptions &programOptions)
+    {
+        if (programOptions.useSearch)
+            return needsLabels(programOptions) ? SEARCH_QUERY.text() : UNLABELED_SEARCH_QUERY.text();
+
+        return needsLabels(programOptions) ? ISSUES_QUERY.text() : UNLABELED_ISSUES_QUERY.text();
+    }
+
+    // The search syntax has no escapes, so a name with these can't be put in a qualifier
+    bool isQuotable(std::string_view label)
+    {
+        const auto isUnquotable = [](const char c)
+        {
+            return (c == '"') || (c == '\\') || (static_cast<unsigned char>(c) < 0x20) || (c == 0x7F);
+        };
+
+        return std::none_of(label.cbegin(), label.cend(), isUnquotable);
+    }
 }
 
+// The fields of an issue of a page, read by readConnection(). They live in the page arena,
+// only what is kept is copied out of it.
+struct IssueGatherer::IssueNode {
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
+    explicit IssueNode(const allocator_type &allocator)
+        : id(allocator)
+        , createdAt(allocator)
+        , updatedAt(allocator)
+        , labelNames(allocator)
+    {
+    }
+
+    IssueNode(IssueNode &&other, const allocator_type &allocator)
+        : id(std::move(other.id), allocator)
+        , createdAt(std::move(other.createdAt), allocator)
+        , updatedAt(std::move(other.updatedAt), allocator)
+        , labelCount(other.labelCount)
+        , labelIDs(std::move(other.labelIDs))
+        , labelNames(std::move(other.labelNames), allocator)
+    {
+    }
+
+    std::pmr::string id;
+    std::pmr::string createdAt;
+    std::pmr::string updatedAt;
+    // -1 if the labels weren't requested
+    int labelCount = -1;
+    LabelHandles labelIDs;
+    std::pmr::vector<LabelHandle> labelNames;
+
+    // The values are copied or interned, so the parser keeps reusing their buffers
+    void set(const FieldPath &path, std::string &value)
+    {
+        if (path.is({"id"}))
+            id.assign(value);
+        else if (path.is({"createdAt"}))
+            createdAt.assign(value);
+        else if (path.is({"updatedAt"}))
+            updatedAt.assign(value);
+        else if (path.is({"labels", "nodes", "id"}))
+            labelIDs.push_back(LabelTable::instance().internID(value));
+        else if (path.is({"labels", "nodes", "name"}))
+            labelNames.push_back(LabelTable::instance().internName(value));
+    }
+
+    void set(const FieldPath &path, long long value)
+    {
+        if (path.is({"labels", "totalCount"}))
+            labelCount = static_cast<int>(value);
+    }
+};
+
 IssueGatherer::IssueGatherer(const ProgramOptions &programOptions, PostDownloader &downloader,
-                           std::vector<std::string> &issues,
-                           std::string &error)
+                           std::vector<IssueAttributes> &issues,
+                           std::string &error, const CreatedRange &range)
     : m_programOptions(programOptions)
     , m_downloader(downloader)
     , m_issues(issues)
     , m_error(error)
-    , m_body1part(generateBody1Part())
-    , m_body2part(") { nodes { id createdAt updatedAt labels(first:100){ nodes { name } } } pageInfo { endCursor hasNextPage } } } }")
+    , m_request(programOptions.useSearch
+                ? GraphQLRequest(issuesQuery(programOptions))
+                : GraphQLRequest(issuesQuery(programOptions), {{"owner", programOptions.repoOwner}, {"name", programOptions.repoName}}))
+    , m_labelsRequest(ISSUE_LABELS_QUERY.text())
+    , m_searchQuery(programOptions.useSearch ? (searchQuery(programOptions) + " sort:created-asc") : std::string{})
+    , m_range(range)
+    , m_pageBuffer(PAGE_ARENA_SIZE)
+    , m_pageArena(m_pageBuffer.data(), m_pageBuffer.size())
+    , m_needsLabels(needsLabels(programOptions))
 {
     m_error.clear();
+
+    for (const std::string &label : programOptions.labelList)
+        m_skippedLabels.push_back(LabelTable::instance().internName(label));
 }
 
-void IssueGatherer::run()
-{
-    m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueGatherer::onFinishedPage, this));
+IssueGatherer::~IssueGatherer() = default;
 
-    json req;
-    req["query"] = m_body1part + m_body2part;
-    m_downloader.setRequestBody(req.dump());
+void IssueGatherer::run(std::string_view firstPage)
+{
+    if (firstPage.empty()) {
+        preparePageRequest();
+    }
+    else {
+        // The first page came with the bootstrap query
+        gatherIssues(firstPage);
+        if (!m_error.empty() || !prepareNextRequest())
+            return;
+    }
 
+    m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueGatherer::onFinishedPage, this));
+    m_downloader.setBodyHandler(beast::bind_front_handler(&IssueGatherer::onPageData, this));
     m_downloader.run();
     m_downloader.setFinishedHandler(FinishedHandler{});
+    m_downloader.setBodyHandler(BodyHandler{});
+}
+
+void IssueGatherer::addFirstPage(const ProgramOptions &programOptions, BootstrapQuery &query)
+{
+    // Each shard downloads its own first page
+    if (programOptions.shards > 1)
+        return;
+
+    query.addVariable("$after: String");
+
+    if (programOptions.useSearch) {
+        query.addVariable("$query: String!", searchQuery(programOptions) + " sort:created-asc");
+        if (needsLabels(programOptions)) {
+            query.addVariable("$labels: Int!", LabelProjection{}.size());
+            query.addFields(SEARCH_FIELDS.text());
+        }
+        else {
+            query.addFields(UNLABELED_SEARCH_FIELDS.text());
+        }
+    }
+    else if (needsLabels(programOptions)) {
+        query.addVariable("$labels: Int!", LabelProjection{}.size());
+        query.addRepositoryFields(ISSUES_FIELDS.text());
+    }
+    else {
+        query.addRepositoryFields(UNLABELED_ISSUES_FIELDS.text());
+    }
 }
 
 void IssueGatherer::onFinishedPage()
@@ -79,21 +267,174 @@ void IssueGatherer::onFinishedPage()
         return;
     }
 
-    gatherIssues(m_downloader.response().body());
+    if (m_incompleteEnd > 0)
+        completeLabels(m_downloader.response().body());
+    else
+        finishPageStream();
 
-    if (m_error.empty() && m_hasNext) {
-        const std::string body = m_body1part + ", after:\"" + m_cursor + "\"" + m_body2part;
-
-        json req;
-        req["query"] = body;
-        m_downloader.setRequestBody(req.dump());
+    if (m_error.empty() && prepareNextRequest())
         m_downloader.sendRequest();
+}
+
+// Reads the issues of a page while it downloads
+void IssueGatherer::onPageData(std::string_view chunk)
+{
+    if (!m_pageStream)
+        return;
+
+    try {
+        m_pageStream->feed(chunk);
+    }
+    catch (const std::exception &e) {
+        m_pageStream.reset();
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+void IssueGatherer::finishPageStream()
+{
+    // The stream failed while the page was downloading
+    if (!m_pageStream)
+        return;
+
+    try {
+        finishPage(m_pageStream->finish(), m_downloader.response().body());
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+
+    m_pageStream.reset();
+}
+
+// Sets the body of the next request. Returns false if the gathering is complete.
+bool IssueGatherer::prepareNextRequest()
+{
+    if (!m_hasNext && (m_incompletePos < m_incompleteIssues.size())) {
+        m_pageStream.reset();
+        m_downloader.setRequestBody(labelsRequestBody());
+
+        std::cout << "Downloading the labels of " << (m_incompleteEnd - m_incompletePos) << " issues" << std::endl;
+        return true;
+    }
+
+    if (m_hasNext) {
+        preparePageRequest();
 
         std::cout << "Downloading next Issues cursor: " << m_cursor << std::endl;
+        return true;
     }
+
+    return false;
+}
+
+void IssueGatherer::preparePageRequest()
+{
+    m_downloader.setRequestBody(requestBody());
+
+    m_pageStream.reset();
+    m_pageArena.release();
+    m_pageStream = std::make_unique<ConnectionStream<IssueNode>>(connectionPath(), [this](IssueNode &node) { return gatherIssue(node); },
+                                                                 "endCursor", "hasNextPage", &m_pageArena);
+}
+
+std::vector<std::string_view> IssueGatherer::connectionPath() const
+{
+    if (m_programOptions.useSearch)
+        return {"data", "search"};
+
+    return {"data", "repository", "issues"};
 }
 
+// Used for the first page, which comes with the bootstrap query
 void IssueGatherer::gatherIssues(std::string_view response)
+{
+    m_pageArena.release();
+
+    try {
+        finishPage(readConnection<IssueNode>(response, connectionPath(), "endCursor", "hasNextPage",
+                                             [this](IssueNode &node) { return gatherIssue(node); }, &m_pageArena),
+                   response);
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+// Returns false when the issue was created after the cutoff, since the rest were too
+bool IssueGatherer::gatherIssue(IssueNode &node)
+{
+    if (m_programOptions.useSearch && !acceptSearchResult(node.id, node.createdAt))
+        return true;
+
+    timePoint createdTimepoint;
+    if (!parseISOTimePoint(node.createdAt, createdTimepoint))
+        return true;
+
+    timePoint updatedTimepoint;
+    if (!parseISOTimePoint(node.updatedAt, updatedTimepoint))
+        return true;
+
+    if (createdTimepoint >= m_programOptions.cutoffTimePoint) {
+        m_hasNext = false;
+        return false;
+    }
+
+    if (updatedTimepoint >= m_programOptions.cutoffTimePoint)
+        return true;
+
+    if ((node.labelCount < 0) || !m_needsLabels) {
+        m_issues.emplace_back(node.id);
+        return true;
+    }
+
+    m_labelProjection.observe(node.labelCount);
+    if (hasSkippedLabel(node.labelNames))
+        return true;
+
+    // The labels that weren't fetched might include a skipped one, and all of them are kept when closing
+    if (node.labelCount > static_cast<int>(node.labelIDs.size())) {
+        m_incompleteIssues.emplace_back(node.id);
+        return true;
+    }
+
+    m_issues.emplace_back(node.id, std::move(node.labelIDs));
+    return true;
+}
+
+// The issues of the page were already gathered
+void IssueGatherer::finishPage(const Connection<IssueNode> &connection, std::string_view response)
+{
+    if (connection.hasErrors) {
+        m_error = "The last API call returned an error:\n" + json::parse(response).dump();
+        return;
+    }
+
+    // The cutoff date stopped the gathering
+    if (connection.isStopped)
+        return;
+
+    if (!connection.isFound) {
+        m_error = "The API response has no issues:\n" + std::string(response);
+        return;
+    }
+
+    if (m_programOptions.useSearch && m_isNewSearch) {
+        std::cout << "The search matched " << connection.count << " issues" << std::endl;
+        m_isNewSearch = false;
+    }
+
+    m_hasNext = connection.pageInfo.hasNext;
+    m_cursor = connection.pageInfo.cursor;
+
+    if (m_programOptions.useSearch && !m_hasNext)
+        restartSearch(static_cast<int>(connection.count));
+}
+
+void IssueGatherer::completeLabels(std::string_view response)
 {
     try {
         const json data = json::parse(response);
@@ -102,51 +443,29 @@ void IssueGatherer::gatherIssues(std::string_view response)
             return;
         }
 
-        const json nodes = data["data"]["repository"]["issues"]["nodes"];
-        for (const auto &node : nodes) {
-            const std::string createdAt = node["createdAt"].get<std::string>();
-            timePoint createdTimepoint;
-            if (!parseISOTimePoint(createdAt, createdTimepoint))
-                continue;
+        // The nodes are in the order of the requested IDs
+        const json &nodes = data["data"]["nodes"];
+        if (nodes.size() != (m_incompleteEnd - m_incompletePos)) {
+            m_error = "The API returned the labels of " + std::to_string(nodes.size()) + " issues instead of "
+                    + std::to_string(m_incompleteEnd - m_incompletePos);
+            return;
+        }
 
-            const std::string updatedAt = node["updatedAt"].get<std::string>();
-            timePoint updatedTimepoint;
-            if (!parseISOTimePoint(updatedAt, updatedTimepoint))
+        for (const auto &node : nodes) {
+            const std::string &id = m_incompleteIssues[m_incompletePos++];
+            // The issue was deleted or transferred in the meantime
+            if (node.is_null())
                 continue;
 
-            if (createdTimepoint >= m_programOptions.cutoffTimePoint) {
-                m_hasNext = false;
+            if (node["id"].get<std::string>() != id) {
+                m_error = "Failed to download the labels of issue: " + id;
                 return;
             }
 
-            if (updatedTimepoint >= m_programOptions.cutoffTimePoint)
-                continue;
-
-            std::vector<std::string> labels = gatherLabels(node["labels"]["nodes"]);
-            // Check if labels match
-
-            bool labelMatch = false;
-            for (const auto &label : m_programOptions.labelList) {
-                const auto pred = [&label](const std::string &labelTest)
-                {
-                    return boost::algorithm::iequals(label, labelTest);
-                };
-
-                if (std::any_of(labels.cbegin(), labels.cend(), pred)) {
-                    labelMatch = true;
-                    break;
-                }
-            }
-
-            if (labelMatch)
-                continue;
-
-            m_issues.emplace_back(node["id"].get<std::string>());
+            const json &labelsNodes = node["labels"]["nodes"];
+            if (!hasSkippedLabel(gatherLabels(labelsNodes)))
+                m_issues.emplace_back(id, gatherLabelIDs(labelsNodes));
         }
-
-        const json pageinfo = data["data"]["repository"]["issues"]["pageInfo"];
-        m_hasNext = pageinfo["hasNextPage"].get<bool>();
-        m_cursor = pageinfo["endCursor"].get<std::string>();
     }
     catch (const std::exception &e) {
         m_error += "Exception: ";
@@ -154,21 +473,123 @@ void IssueGatherer::gatherIssues(std::string_view response)
     }
 }
 
-std::vector<std::string> IssueGatherer::gatherLabels (const json &LabelsNodes)
+// The names are interned case insensitively, so the handles are compared
+bool IssueGatherer::hasSkippedLabel(const std::pmr::vector<LabelHandle> &labels) const
+{
+    const auto isSkipped = [this](const LabelHandle label)
+    {
+        return std::find(m_skippedLabels.cbegin(), m_skippedLabels.cend(), label) != m_skippedLabels.cend();
+    };
+
+    return std::any_of(labels.cbegin(), labels.cend(), isSkipped);
+}
+
+std::pmr::vector<LabelHandle> IssueGatherer::gatherLabels (const json &LabelsNodes)
 {
-    std::vector<std::string> labels;
+    std::pmr::vector<LabelHandle> labels;
 
     for (const auto &node : LabelsNodes)
-        labels.emplace_back(node["name"].get<std::string>());
+        labels.push_back(LabelTable::instance().internName(node["name"].get<std::string>()));
 
     return labels;
 }
 
-std::string IssueGatherer::generateBody1Part()
+LabelHandles IssueGatherer::gatherLabelIDs(const json &labelsNodes)
+{
+    LabelHandles labelIDs;
+
+    for (const auto &node : labelsNodes)
+        labelIDs.push_back(LabelTable::instance().internID(node["id"].get<std::string>()));
+
+    return labelIDs;
+}
+
+std::string IssueGatherer::requestBody() const
+{
+    json variables = json::object();
+    if (!m_cursor.empty())
+        variables["after"] = m_cursor;
+
+    if (m_needsLabels)
+        variables["labels"] = m_labelProjection.size();
+
+    if (m_programOptions.useSearch) {
+        if ((m_range.from == "*") && (m_range.to == "*"))
+            variables["query"] = m_searchQuery;
+        else
+            variables["query"] = m_searchQuery + " created:" + m_range.from + ".." + m_range.to;
+    }
+
+    return m_request.body(variables);
+}
+
+std::string IssueGatherer::labelsRequestBody()
 {
-    return "query { repository(owner:\"" +
-            m_programOptions.repoOwner +
-            "\", name:\"" +
-            m_programOptions.repoName +
-            "\") { issues(first:100, states:OPEN, orderBy:{field:CREATED_AT, direction:ASC}";
+    m_incompleteEnd = std::min(m_incompletePos + MAX_NODE_IDS, m_incompleteIssues.size());
+
+    json ids = json::array();
+    for (auto i = m_incompletePos; i < m_incompleteEnd; ++i)
+        ids.push_back(m_incompleteIssues[i]);
+
+    return m_labelsRequest.body({{"ids", ids}});
+}
+
+std::string IssueGatherer::searchQuery(const ProgramOptions &programOptions)
+{
+    const auto cutoff = std::chrono::floor<std::chrono::seconds>(programOptions.cutoffTimePoint);
+    std::string query = "repo:" + programOptions.repoOwner + "/" + programOptions.repoName
+            + " is:issue is:open updated:<" + date::format("%FT%T+00:00", cutoff);
+
+    // The quotes keep a name with spaces in one qualifier. The qualifiers only save pages,
+    // the issues with a skipped label are dropped by gatherIssue() whether they are excluded here or not.
+    for (const auto &label : programOptions.labelList) {
+        if (isQuotable(label))
+            query += " -label:\"" + label + '"';
+    }
+
+    return query;
+}
+
+std::string_view IssueGatherer::queryDocument(const ProgramOptions &programOptions)
+{
+    return issuesQuery(programOptions);
+}
+
+bool IssueGatherer::acceptSearchResult(std::string_view id, std::string_view createdAt)
+{
+    ++m_searchResults;
+
+    // After a restart the first results overlap with the ones already gathered
+    if ((createdAt == m_restartCreatedAt) && (m_restartIDs.count(std::string(id)) > 0))
+        return false;
+
+    if (createdAt != m_lastCreatedAt) {
+        m_lastCreatedAt = createdAt;
+        m_lastCreatedIDs.clear();
+    }
+    m_lastCreatedIDs.emplace(id);
+    ++m_newSearchResults;
+
+    return true;
+}
+
+void IssueGatherer::restartSearch(int issueCount)
+{
+    // The search API stops after SEARCH_RESULTS_LIMIT results even if more issues matched.
+    // The results are sorted by creation date so continue with a new search
+    // whose creation range starts from the creation date of the last result.
+    if ((m_searchResults < SEARCH_RESULTS_LIMIT) || (m_searchResults >= issueCount) || (m_newSearchResults == 0))
+        return;
+
+    std::cout << "Restarting the search from: " << m_lastCreatedAt << std::endl;
+
+    m_range.from = m_lastCreatedAt;
+    m_restartCreatedAt = m_lastCreatedAt;
+    m_restartIDs.swap(m_lastCreatedIDs);
+    m_lastCreatedIDs.clear();
+    m_searchResults = 0;
+    m_newSearchResults = 0;
+    m_isNewSearch = true;
+    m_cursor.clear();
+    m_hasNext = true;
 }
@@ -22,41 +22,109 @@ SOFTWARE. */
 
 #pragma once
 
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <unordered_set>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include "connectionreader.h"
+#include "graphqlrequest.h"
+#include "labelprojection.h"
+#include "labeltable.h"
+
 using json = nlohmann::json;
 
+class BootstrapQuery;
+struct IssueAttributes;
 class ProgramOptions;
 class PostDownloader;
 
+// Inclusive range of issue creation dates used by the search mode. "*" means unbounded.
+struct CreatedRange {
+    std::string from = "*";
+    std::string to = "*";
+};
+
 class IssueGatherer
 {
 public:
     // The passed arguments must outlive the class instance
     explicit IssueGatherer(const ProgramOptions &programOptions, PostDownloader &downloader,
-                           std::vector<std::string> &issues,
-                           std::string &error);
+                           std::vector<IssueAttributes> &issues,
+                           std::string &error, const CreatedRange &range = {});
+    ~IssueGatherer();
 
-    void run();
+    // The first page may come from the response of the bootstrap query
+    void run(std::string_view firstPage = {});
+
+    // The search qualifiers that select the issues to close, without any sorting or creation range
+    static std::string searchQuery(const ProgramOptions &programOptions);
+    // The GraphQL document of each page, used to estimate its cost
+    static std::string_view queryDocument(const ProgramOptions &programOptions);
+    // Adds the request of the first page to the bootstrap query
+    static void addFirstPage(const ProgramOptions &programOptions, BootstrapQuery &query);
 
 private:
-    void onFinishedPage();
+    struct IssueNode;
 
-    std::vector<std::string> gatherLabels (const json &LabelsNodes);
+    void onFinishedPage();
+    void onPageData(std::string_view chunk);
+    void finishPageStream();
+    bool prepareNextRequest();
+    void preparePageRequest();
+    std::vector<std::string_view> connectionPath() const;
+
+    std::pmr::vector<LabelHandle> gatherLabels (const json &LabelsNodes);
+    LabelHandles gatherLabelIDs(const json &labelsNodes);
     void gatherIssues(std::string_view response);
-    std::string generateBody1Part();
+    bool gatherIssue(IssueNode &node);
+    void finishPage(const Connection<IssueNode> &connection, std::string_view response);
+    void completeLabels(std::string_view response);
+    bool hasSkippedLabel(const std::pmr::vector<LabelHandle> &labels) const;
+    std::string requestBody() const;
+    std::string labelsRequestBody();
+    bool acceptSearchResult(std::string_view id, std::string_view createdAt);
+    void restartSearch(int issueCount);
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
-    std::vector<std::string> &m_issues;
+    std::vector<IssueAttributes> &m_issues;
     std::string &m_error;
 
 
-    const std::string m_body1part;
-    const std::string m_body2part;
+    const GraphQLRequest m_request;
+    const GraphQLRequest m_labelsRequest;
+    const std::string m_searchQuery;
+    CreatedRange m_range;
     std::string m_cursor;
     bool m_hasNext = false;
+    // The nodes of the page that is read, released before the next page
+    std::vector<std::byte> m_pageBuffer;
+    std::pmr::monotonic_buffer_resource m_pageArena;
+    // Reads the issues of the page that is downloading. Null while other requests are.
+    std::unique_ptr<ConnectionStream<IssueNode>> m_pageStream;
+
+    // The labels are needed to skip issues or to apply the label when closing
+    const bool m_needsLabels;
+    // The names of --skip-label in the LabelTable
+    std::vector<LabelHandle> m_skippedLabels;
+    // Issues with more labels than the page fetched
+    LabelProjection m_labelProjection;
+    std::vector<std::string> m_incompleteIssues;
+    std::vector<std::string>::size_type m_incompletePos = 0;
+    std::vector<std::string>::size_type m_incompleteEnd = 0;
+
+    // Used to continue a search past the limit of results per search
+    std::string m_lastCreatedAt;
+    std::unordered_set<std::string> m_lastCreatedIDs;
+    std::string m_restartCreatedAt;
+    std::unordered_set<std::string> m_restartIDs;
+    int m_searchResults = 0;
+    int m_newSearchResults = 0;
+    bool m_isNewSearch = true;
 };
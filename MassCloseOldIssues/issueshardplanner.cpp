@@ -0,0 +1,291 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "issueshardplanner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+#include "HowardHinnant/date.h"
+
+#include "postdownloader.h"
+#include "programoptions.h"
+#include "querytemplate.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    // The creation range is probed in this many sub-ranges per shard,
+    // and a probed range with too many issues is split in this many too
+    constexpr int PROBES_PER_SHARD = 4;
+    // Don't bother splitting if all the issues fit in a few pages
+    constexpr int MIN_ISSUES_PER_SHARD = 200;
+
+    constexpr QueryTemplate BOUNDS_QUERY{"query($oldest: String!, $newest: String!) { "
+                                         "oldest: search(query:$oldest, type:ISSUE, first:1) { issueCount nodes { ... on Issue { createdAt } } } "
+                                         "newest: search(query:$newest, type:ISSUE, first:1) { nodes { ... on Issue { createdAt } } } }"};
+    static_assert(BOUNDS_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate COUNT_VARIABLE{"$q%n: String!"};
+    constexpr QueryTemplate COUNT_ALIAS{"count%n: search(query:$q%n, type:ISSUE) { issueCount } "};
+
+    std::string formatTimePoint(std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds> tp)
+    {
+        return date::format("%FT%TZ", tp);
+    }
+}
+
+IssueShardPlanner::IssueShardPlanner(const ProgramOptions &programOptions, PostDownloader &downloader,
+                                     std::string &error)
+    : m_programOptions(programOptions)
+    , m_downloader(downloader)
+    , m_error(error)
+    , m_searchQuery(IssueGatherer::searchQuery(programOptions))
+{
+    m_error.clear();
+}
+
+void IssueShardPlanner::run()
+{
+    m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueShardPlanner::onFinishedPage, this));
+    m_downloader.setRequestBody(makeBoundsRequest());
+    m_downloader.run();
+    m_downloader.setFinishedHandler(FinishedHandler{});
+}
+
+std::vector<CreatedRange> IssueShardPlanner::shards() const
+{
+    return m_shards;
+}
+
+void IssueShardPlanner::onFinishedPage()
+{
+    if (!m_downloader.error().empty()) {
+        m_error = m_downloader.error();
+        return;
+    }
+
+    if (m_downloader.response().base().result() != http::status::ok) {
+        m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
+        return;
+    }
+
+    if (m_probeBounds.empty()) {
+        gatherBounds(m_downloader.response().body());
+
+        if (m_error.empty() && !m_probeBounds.empty()) {
+            m_downloader.setRequestBody(makeCountsRequest());
+            m_downloader.sendRequest();
+        }
+    }
+    else {
+        gatherCounts(m_downloader.response().body());
+        if (!m_error.empty())
+            return;
+
+        if (subdivideProbes()) {
+            m_downloader.setRequestBody(makeCountsRequest());
+            m_downloader.sendRequest();
+        }
+        else {
+            splitShards();
+        }
+    }
+}
+
+void IssueShardPlanner::gatherBounds(std::string_view response)
+{
+    try {
+        const json data = json::parse(response);
+        if (data.contains("errors")) {
+            m_error = "The last API call returned an error:\n" + data.dump();
+            return;
+        }
+
+        const json &oldest = data["data"]["oldest"];
+        const json &newest = data["data"]["newest"];
+        m_issueCount = oldest["issueCount"].get<int>();
+        if ((m_issueCount == 0) || oldest["nodes"].empty() || newest["nodes"].empty())
+            return;
+
+        std::istringstream in{oldest["nodes"][0]["createdAt"].get<std::string>() + " " + newest["nodes"][0]["createdAt"].get<std::string>()};
+        in >> date::parse("%FT%TZ", m_oldest) >> std::ws >> date::parse("%FT%TZ", m_newest);
+        if (in.fail()) {
+            m_error = "Failed to parse the creation dates of the oldest and newest issues";
+            return;
+        }
+
+        // Everything fits in one shard
+        const int shardCount = std::min(m_programOptions.shards, m_issueCount / MIN_ISSUES_PER_SHARD);
+        if (shardCount <= 1) {
+            m_shards.push_back({});
+            return;
+        }
+
+        const int probeCount = shardCount * PROBES_PER_SHARD;
+        const auto step = (m_newest - m_oldest + std::chrono::seconds(1)) / probeCount;
+        if (step < std::chrono::seconds(1)) {
+            m_shards.push_back({});
+            return;
+        }
+
+        m_shardCount = shardCount;
+        for (int i = 0; i < probeCount; ++i) {
+            m_probeBounds.push_back(m_oldest + (i * step));
+            m_pendingProbes.push_back(i);
+        }
+        m_probeBounds.push_back(m_newest + std::chrono::seconds(1));
+        m_probeCounts.assign(probeCount, 0);
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+void IssueShardPlanner::gatherCounts(std::string_view response)
+{
+    try {
+        const json data = json::parse(response);
+        if (data.contains("errors")) {
+            m_error = "The last API call returned an error:\n" + data.dump();
+            return;
+        }
+
+        const json &aliases = data["data"];
+        for (std::vector<int>::size_type i = 0; i < m_pendingProbes.size(); ++i)
+            m_probeCounts[m_pendingProbes[i]] = aliases["count" + std::to_string(i)]["issueCount"].get<int>();
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+    }
+}
+
+// The issues are usually skewed towards the recent dates, and a bulk import puts many of them
+// in a short range. A probed range with more issues than a shard can't be balanced by merging,
+// so it is split and probed again, until it fits or it is one second long.
+// Returns true if there are new ranges to probe.
+bool IssueShardPlanner::subdivideProbes()
+{
+    int total = 0;
+    for (const int count : m_probeCounts)
+        total += count;
+
+    const double target = static_cast<double>(total) / m_shardCount;
+    std::vector<timePoint> bounds;
+    std::vector<int> counts;
+    m_pendingProbes.clear();
+
+    for (std::vector<int>::size_type i = 0; i < m_probeCounts.size(); ++i) {
+        const auto width = std::chrono::duration_cast<std::chrono::seconds>(m_probeBounds[i + 1] - m_probeBounds[i]);
+        const auto pieces = std::min<std::chrono::seconds::rep>(PROBES_PER_SHARD, width.count());
+        if ((m_probeCounts[i] <= target) || (pieces < 2)) {
+            bounds.push_back(m_probeBounds[i]);
+            counts.push_back(m_probeCounts[i]);
+            continue;
+        }
+
+        const auto step = width / pieces;
+        for (std::chrono::seconds::rep piece = 0; piece < pieces; ++piece) {
+            m_pendingProbes.push_back(counts.size());
+            bounds.push_back(m_probeBounds[i] + (piece * step));
+            counts.push_back(0);
+        }
+    }
+    bounds.push_back(m_probeBounds.back());
+
+    m_probeBounds.swap(bounds);
+    m_probeCounts.swap(counts);
+
+    return !m_pendingProbes.empty();
+}
+
+void IssueShardPlanner::splitShards()
+{
+    // Greedily merge adjacent probed ranges until each shard holds
+    // about issueCount/shards issues
+    int total = 0;
+    for (const int count : m_probeCounts)
+        total += count;
+
+    const double target = static_cast<double>(total) / m_shardCount;
+    timePoint shardBegin = m_probeBounds.front();
+    int accumulated = 0;
+
+    for (std::vector<int>::size_type i = 0; i < m_probeCounts.size(); ++i) {
+        accumulated += m_probeCounts[i];
+
+        const bool isLast = (i == (m_probeCounts.size() - 1));
+        const bool isFull = accumulated >= (target * (m_shards.size() + 1));
+        if (!isLast && (!isFull || (static_cast<int>(m_shards.size()) == (m_shardCount - 1))))
+            continue;
+
+        // The creation range of a search is inclusive
+        const timePoint shardEnd = m_probeBounds[i + 1] - std::chrono::seconds(1);
+        m_shards.push_back({formatTimePoint(shardBegin), formatTimePoint(shardEnd)});
+        shardBegin = m_probeBounds[i + 1];
+    }
+
+    std::cout << "Split " << total << " issues into " << m_shards.size() << " shards" << std::endl;
+}
+
+std::string IssueShardPlanner::makeBoundsRequest() const
+{
+    json req;
+    req["query"] = BOUNDS_QUERY.text();
+    req["variables"]["oldest"] = m_searchQuery + " sort:created-asc";
+    req["variables"]["newest"] = m_searchQuery + " sort:created-desc";
+
+    return req.dump();
+}
+
+std::string IssueShardPlanner::makeCountsRequest() const
+{
+    // Sample QraphQL string with one probed range
+    // "query($q0: String!) { count0: search(query:$q0, type:ISSUE) { issueCount } }"
+    std::string query = "query(";
+    std::string aliases;
+    json variables;
+
+    for (std::vector<int>::size_type i = 0; i < m_pendingProbes.size(); ++i) {
+        if (i > 0)
+            query += ", ";
+        writeQuery<COUNT_VARIABLE>(query, i);
+        writeQuery<COUNT_ALIAS>(aliases, i, i);
+
+        const auto probe = m_pendingProbes[i];
+        const timePoint end = m_probeBounds[probe + 1] - std::chrono::seconds(1);
+        variables["q" + std::to_string(i)] = m_searchQuery + " created:" + formatTimePoint(m_probeBounds[probe]) + ".." + formatTimePoint(end);
+    }
+    query += ") { " + aliases + "}";
+
+    json req;
+    req["query"] = query;
+    req["variables"] = variables;
+
+    return req.dump();
+}
@@ -0,0 +1,73 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "issuegatherer.h"
+
+class ProgramOptions;
+class PostDownloader;
+
+// Splits the creation dates of the issues to close into ranges with roughly
+// the same number of issues. Each range can then be searched in parallel.
+class IssueShardPlanner
+{
+public:
+    // The passed arguments must outlive the class instance
+    explicit IssueShardPlanner(const ProgramOptions &programOptions, PostDownloader &downloader,
+                               std::string &error);
+
+    void run();
+    std::vector<CreatedRange> shards() const;
+
+private:
+    using timePoint = std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>;
+
+    void onFinishedPage();
+
+    void gatherBounds(std::string_view response);
+    void gatherCounts(std::string_view response);
+    bool subdivideProbes();
+    void splitShards();
+    std::string makeBoundsRequest() const;
+    std::string makeCountsRequest() const;
+
+    const ProgramOptions &m_programOptions;
+    PostDownloader &m_downloader;
+    std::string &m_error;
+
+    const std::string m_searchQuery;
+    int m_issueCount = 0;
+    timePoint m_oldest;
+    timePoint m_newest;
+    int m_shardCount = 0;
+    // The probed ranges are [m_probeBounds[i], m_probeBounds[i+1])
+    std::vector<timePoint> m_probeBounds;
+    std::vector<int> m_probeCounts;
+    // The probed ranges whose counts are requested next
+    std::vector<std::vector<int>::size_type> m_pendingProbes;
+    std::vector<CreatedRange> m_shards;
+};
@@ -22,30 +22,263 @@ SOFTWARE. */
 
 #include "issueupdater.h"
 
+#include <algorithm>
 #include <iostream>
-#include <sstream>
+#include <string_view>
+#include <unordered_map>
 
 #include <nlohmann/json.hpp>
 
+#include "HowardHinnant/date.h"
+
+#include "issueattributes.h"
+#include "labeltable.h"
+#include "mutationresult.h"
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
 namespace
 {
-    constexpr int BATCH_SIZE = 10;
+    constexpr int INITIAL_BATCH_SIZE = 10;
+    // Each issue needs up to 4 mutations
+    constexpr int MAX_BATCH_SIZE = 25;
+    // Consecutive failures of a whole batch
+    constexpr int MAX_RETRIES = 5;
+    // Attempts of an issue whose aliases keep failing
+    constexpr int MAX_ISSUE_ATTEMPTS = 3;
+
+    // The steps of each issue in the MutationQueue
+    constexpr MutationQueue::Steps COMMENT_STEP = 1;
+    constexpr MutationQueue::Steps LABEL_STEP = 2;
+    constexpr MutationQueue::Steps CLOSE_STEP = 4;
+    constexpr MutationQueue::Steps LOCK_STEP = 8;
+    // Closing, labeling or locking an issue twice leaves it as once. A second comment would be posted.
+    constexpr MutationQueue::Steps REPEATABLE_STEPS = LABEL_STEP | CLOSE_STEP | LOCK_STEP;
+
+    constexpr QueryTemplate MUTATION_RESULT{" { clientMutationId } "};
+    // The comment is the $body variable, so its text is sent once per batch instead of once per issue
+    constexpr auto COMMENT_ALIAS = QueryTemplate{"comment%n: addComment(input: {subjectId:\"%s\", body:$body})"} + MUTATION_RESULT;
+    constexpr std::string_view COMMENT_VARIABLE = "($body: String!)";
+    constexpr auto LABEL_ALIAS = QueryTemplate{"label%n: addLabelsToLabelable(input: {labelableId:\"%s\", labelIds:[\"%s\"]})"} + MUTATION_RESULT;
+    constexpr auto CLOSE_ALIAS = QueryTemplate{"close%n: closeIssue(input: {issueId:\"%s\"})"} + MUTATION_RESULT;
+    // Closes the issue and applies the label with one mutation. labelIds replaces all the labels.
+    constexpr auto UPDATE_ALIAS = QueryTemplate{"update%n: updateIssue(input: {id:\"%s\", state:CLOSED, labelIds:[%s]})"} + MUTATION_RESULT;
+    constexpr auto LOCK_ALIAS = QueryTemplate{"lock%n: lockLockable(input: {lockableId:\"%s\"})"} + MUTATION_RESULT;
+
+    // The upcoming issues are revalidated right before they are updated, as many as nodes(ids:) accepts at once
+    constexpr QueryTemplate REVALIDATION_QUERY{"query($ids: [ID!]!) { nodes(ids:$ids) { ... on Issue { id state updatedAt } } }"};
+    static_assert(REVALIDATION_QUERY.isBalanced(), "Unbalanced GraphQL query");
+    constexpr std::size_t REVALIDATION_WINDOW = 100;
+
+    // What the errors of a response without data say about the batch
+    enum class BatchFailure
+    {
+        Other,
+        // The query ran out of time and may have been applied in part
+        Timeout,
+        // The query was rejected before it ran
+        TooExpensive
+    };
+
+    // GitHub gives a timeout no type, only this message
+    constexpr std::string_view TIMEOUT_MESSAGE = "Something went wrong while executing your query. This may be the result of a timeout";
+    constexpr std::string_view COMPLEXITY_MESSAGE = "Query has complexity of ";
+
+    BatchFailure classifyErrors(const json &errors)
+    {
+        if (!errors.is_array())
+            return BatchFailure::Other;
+
+        for (const auto &error : errors) {
+            if (!error.is_object())
+                continue;
+
+            const auto typeIt = error.find("type");
+            const auto messageIt = error.find("message");
+            const std::string_view type = ((typeIt != error.end()) && typeIt->is_string())
+                    ? std::string_view(typeIt->get_ref<const std::string &>()) : std::string_view{};
+            const std::string_view message = ((messageIt != error.end()) && messageIt->is_string())
+                    ? std::string_view(messageIt->get_ref<const std::string &>()) : std::string_view{};
+
+            if (message.substr(0, TIMEOUT_MESSAGE.size()) == TIMEOUT_MESSAGE)
+                return BatchFailure::Timeout;
+
+            if ((type == "MAX_NODE_LIMIT_EXCEEDED") || (type == "RESOURCE_LIMITS_EXCEEDED")
+                    || (message.substr(0, COMPLEXITY_MESSAGE.size()) == COMPLEXITY_MESSAGE))
+                return BatchFailure::TooExpensive;
+        }
+
+        return BatchFailure::Other;
+    }
+
+    MutationQueue::Steps issueSteps(const ProgramOptions &programOptions)
+    {
+        MutationQueue::Steps steps = CLOSE_STEP;
+        if (!programOptions.comment.empty())
+            steps |= COMMENT_STEP;
+        if (!programOptions.applyLabel.empty())
+            steps |= LABEL_STEP;
+        if (programOptions.lock)
+            steps |= LOCK_STEP;
+
+        return steps;
+    }
+
+    std::string aliasName(std::string_view prefix, const int counter)
+    {
+        return std::string(prefix) + std::to_string(counter);
+    }
+
+    // The mutations of an issue are policies, each with the steps it does and its writer.
+    // write() appends the alias of the pending `steps` it covers, records it in the queue
+    // and clears them from `steps`, so that the following actions skip them.
+    struct CommentAction
+    {
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps &steps, MutationQueue &queue)
+        {
+            if (!(steps & COMMENT_STEP))
+                return;
+
+            writeQuery<COMMENT_ALIAS>(buffer, counter, issue.ID);
+            queue.addAlias(aliasName("comment", counter), COMMENT_STEP);
+        }
+    };
+
+    // Applies the label along with closing when the labels of the issue are known
+    struct UpdateAction
+    {
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps &steps, MutationQueue &queue)
+        {
+            if (!(steps & LABEL_STEP) || !issue.labelIDs)
+                return;
+
+            const LabelHandles &labelIDs = *issue.labelIDs;
+            if (labelIDs.contains(issue.labelID)) {
+                // The label is already applied
+                queue.addAlias({}, LABEL_STEP);
+                steps &= ~LABEL_STEP;
+                return;
+            }
+
+            if (!(steps & CLOSE_STEP))
+                return;
+
+            const LabelTable &labelTable = LabelTable::instance();
+            std::string labelArray;
+            for (const LabelHandle id : labelIDs) {
+                labelArray += '"';
+                labelArray += labelTable.id(id);
+                labelArray += "\", ";
+            }
+            labelArray += '"';
+            labelArray += labelTable.id(issue.labelID);
+            labelArray += '"';
+
+            writeQuery<UPDATE_ALIAS>(buffer, counter, issue.ID, labelArray);
+            queue.addAlias(aliasName("update", counter), LABEL_STEP | CLOSE_STEP);
+            steps &= ~(LABEL_STEP | CLOSE_STEP);
+        }
+    };
+
+    struct LabelAction
+    {
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps &steps, MutationQueue &queue)
+        {
+            if (!(steps & LABEL_STEP))
+                return;
+
+            writeQuery<LABEL_ALIAS>(buffer, counter, issue.ID, LabelTable::instance().id(issue.labelID));
+            queue.addAlias(aliasName("label", counter), LABEL_STEP);
+        }
+    };
+
+    struct CloseAction
+    {
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps &steps, MutationQueue &queue)
+        {
+            if (!(steps & CLOSE_STEP))
+                return;
+
+            writeQuery<CLOSE_ALIAS>(buffer, counter, issue.ID);
+            queue.addAlias(aliasName("close", counter), CLOSE_STEP);
+        }
+    };
+
+    struct LockAction
+    {
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps &steps, MutationQueue &queue)
+        {
+            if (!(steps & LOCK_STEP))
+                return;
+
+            writeQuery<LOCK_ALIAS>(buffer, counter, issue.ID);
+            queue.addAlias(aliasName("lock", counter), LOCK_STEP);
+        }
+    };
+
+    // The writer of the issues for one combination of actions, in the order they are sent.
+    // The actions that the options leave out aren't part of it at all.
+    template <typename... Actions>
+    struct ActionList
+    {
+        template <typename... More>
+        using Append = ActionList<Actions..., More...>;
+
+        static void write(std::string &buffer, const int counter, const IssueAttributes &issue,
+                          MutationQueue::Steps steps, MutationQueue &queue)
+        {
+            (Actions::write(buffer, counter, issue, steps, queue), ...);
+        }
+    };
+
+    template <typename List>
+    IssueUpdater::IssueWriter withLock(const ProgramOptions &programOptions)
+    {
+        if (programOptions.lock)
+            return &List::template Append<LockAction>::write;
+
+        return &List::write;
+    }
+
+    template <typename List>
+    IssueUpdater::IssueWriter withClose(const ProgramOptions &programOptions)
+    {
+        if (!programOptions.applyLabel.empty())
+            return withLock<typename List::template Append<UpdateAction, LabelAction, CloseAction>>(programOptions);
+
+        return withLock<typename List::template Append<CloseAction>>(programOptions);
+    }
+
+    IssueUpdater::IssueWriter selectIssueWriter(const ProgramOptions &programOptions)
+    {
+        if (!programOptions.comment.empty())
+            return withClose<ActionList<CommentAction>>(programOptions);
+
+        return withClose<ActionList<>>(programOptions);
+    }
 }
 
 IssueUpdater::IssueUpdater(const ProgramOptions &programOptions, PostDownloader &downloader,
-                           const std::vector<std::string> &issues,
-                           std::string_view labelID, std::string &error)
+                           const std::vector<IssueAttributes> &issues, std::string &error)
     : m_programOptions(programOptions)
     , m_downloader(downloader)
     , m_issues(issues)
-    , m_labelID(labelID)
     , m_error(error)
-    , m_hasNextBatch(m_issues.size() > 0)
+    , m_batchSizer(INITIAL_BATCH_SIZE, MAX_BATCH_SIZE)
+    , m_queue(issues.size(), issueSteps(programOptions), MAX_ISSUE_ATTEMPTS)
+    , m_writeIssue(selectIssueWriter(programOptions))
+    , m_commentVariables(programOptions.comment.empty() ? std::string{} : json{{"body", programOptions.comment}}.dump())
+    , m_revalidationRequest(REVALIDATION_QUERY.text())
+    // Same format as updatedAt, so the two compare as strings
+    , m_cutoff(date::format("%FT%TZ", std::chrono::floor<std::chrono::seconds>(programOptions.cutoffTimePoint)))
 {
     m_error.clear();
 }
@@ -56,160 +289,347 @@ void IssueUpdater::run()
         return;
 
     m_downloader.setFinishedHandler(beast::bind_front_handler(&IssueUpdater::onFinishedPage, this));
+    sendBatch(false);
+    m_downloader.runSent();
+    m_downloader.setFinishedHandler(FinishedHandler{});
 
-    json req;
-    req["query"] = nextBatch();
-    m_downloader.setRequestBody(req.dump());
+    // Only an error stops the run early, so the issues left mean one went unreported
+    if (m_error.empty() && (hasNextBatch() || (m_queue.batchSize() > 0)))
+        m_error = "The update stopped before all the issues were processed: " + std::string(m_downloader.error());
 
-    m_downloader.run();
-    m_downloader.setFinishedHandler(FinishedHandler{});
+    if (!m_error.empty())
+        return;
+
+    if (m_staleIssues > 0)
+        std::cout << "Skipped " << m_staleIssues << " issues that were closed or updated since they were gathered" << std::endl;
+
+    std::cout << "Updated " << m_updatedIssues << " issues at "
+              << m_batchSizer.issuesPerSecond(m_updatedIssues) << " issues/s. The final batch size was "
+              << m_batchSizer.size() << " issues" << std::endl;
+
+    if (!m_failedIssues.empty()) {
+        m_error = "Failed to update " + std::to_string(m_failedIssues.size()) + " issues:";
+        for (const std::string &id : m_failedIssues)
+            m_error += " " + id;
+    }
 }
 
-std::string IssueUpdater::nextBatch()
+std::string IssueUpdater::nextBatch(MutationQueue::TimePoint sendTime)
 {
     if (!hasNextBatch())
         return {};
 
     // Sample QraphQL string for the mutation with one alias named 'issue0'
-    // "mutation UpdateIssue { comment0: : addComment(input: {subjectId:\"ID\", body:\"COMMENT\"}) { clientMutationId }
-    //                         label0: addLabelsToLabelable(input: {labelableId:\"ID\", labelIds:[\"ID\"]}) { clientMutationId }
-    //                         close0: closeIssue(input: {issueId:\"ID\"\"}) { clientMutationId }
+    // "mutation UpdateIssue($body: String!) { comment0: addComment(input: {subjectId:\"ID\", body:$body}) { clientMutationId }
+    //                         update0: updateIssue(input: {id:\"ID\", state:CLOSED, labelIds:[\"ID\", \"ID\"]}) { clientMutationId }
     //                         lock0: lockLockable(input: {lockableId:\"ID\"}) { clientMutationId } }"
-
-    const std::string start = "mutation UpdateIssue { ";
-    const std::string end = "}";
-
-    int counter = 0;
-    std::ostringstream buffer;
-    buffer << start;
-    for (; ((m_issuePos < m_issues.size()) && (counter < BATCH_SIZE)); ++m_issuePos) {
-        const auto &issueID = m_issues[m_issuePos];
-
-        if (!m_programOptions.comment.empty())
-            buffer << makeCommentAlias(counter, issueID);
-
-        if (!m_labelID.empty())
-            buffer << makeLabelAlias(counter, issueID);
-
-        buffer << makeCloseAlias(counter, issueID);
-
-        if (m_programOptions.lock)
-            buffer << makeLockAlias(counter, issueID);
-
-        ++counter;
+    // When the labels of the issue weren't gathered, update0 is replaced by
+    // "label0: addLabelsToLabelable(input: {labelableId:\"ID\", labelIds:[\"ID\"]}) { clientMutationId }
+    //  close0: closeIssue(input: {issueId:\"ID\"\"}) { clientMutationId }"
+    // The comment goes first, so that it appears before the issue is closed,
+    // and the lock goes last, so that nothing depends on posting to a locked issue.
+    // A retried issue only gets the aliases that failed.
+    // $body is declared only when the batch has a comment, since GraphQL rejects unused variables.
+
+    const std::string_view name = "mutation UpdateIssue";
+    const std::string_view start = " { ";
+    const std::string_view end = "}";
+    // The comment is sent along with the document
+    const std::size_t fixedSize = COMMENT_VARIABLE.size() + m_commentVariables.size() + end.size();
+
+    std::string buffer;
+    buffer.reserve(4096);
+    buffer.append(name);
+    buffer.append(start);
+    m_batchHasComment = false;
+    std::size_t issueSize = 0;
+    while (m_queue.batchSize() < m_batchSizer.size()) {
+        // All the issues need about the same space, so stop before the request gets too big
+        if ((m_queue.batchSize() > 0) && ((buffer.size() + issueSize + fixedSize) > m_batchSizer.maxRequestSize()))
+            break;
+
+        // The issues past the revalidated ones wait for the next batch
+        if ((m_queue.nextIssue() >= m_revalidatedEnd) && (m_revalidatedEnd < m_issues.size()))
+            break;
+
+        const MutationQueue::Item *item = m_queue.takeReady(sendTime);
+        if (!item)
+            break;
+
+        const std::size_t issueBegin = buffer.size();
+        // The alias counter is the position in the batch
+        writeIssueAliases(buffer, m_queue.batchSize() - 1, *item);
+        issueSize = buffer.size() - issueBegin;
     }
 
-    if (m_issuePos == m_issues.size())
-        m_hasNextBatch = false;
+    if (m_batchHasComment)
+        buffer.insert(name.size(), COMMENT_VARIABLE);
 
-    buffer << end;
-    return buffer.str();
+    buffer.append(end);
+    return buffer;
 }
 
 bool IssueUpdater::hasNextBatch()
 {
-    return m_hasNextBatch;
+    return !m_queue.empty();
+}
+
+int IssueUpdater::initialBatchSize()
+{
+    return INITIAL_BATCH_SIZE;
+}
+
+int IssueUpdater::mutationsPerIssue(const ProgramOptions &programOptions)
+{
+    // Closing is always needed
+    int mutations = 1;
+    if (!programOptions.comment.empty())
+        ++mutations;
+    if (programOptions.lock)
+        ++mutations;
+
+    return mutations;
 }
 
 void IssueUpdater::onFinishedPage()
 {
+    if (m_isRevalidating) {
+        onRevalidated();
+        return;
+    }
+
+    const auto latency = std::chrono::steady_clock::now() - m_batchSentTime;
+
     if (!m_downloader.error().empty()) {
-        m_error = m_downloader.error();
+        // Most likely a timeout. The connection can't be used anymore.
+        if (rewindUnansweredBatch(m_downloader.error()))
+            sendBatch(true);
+        return;
+    }
+
+    const http::status status = m_downloader.response().base().result();
+    if ((status == http::status::bad_gateway) || (status == http::status::gateway_timeout)) {
+        if (rewindUnansweredBatch("HTTP status code " + std::to_string(m_downloader.response().base().result_int())))
+            sendBatch(!m_downloader.isKeptAlive());
         return;
     }
 
-    if (m_downloader.response().base().result() != http::status::ok) {
+    if (status != http::status::ok) {
         m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
         return;
     }
 
-    checkResponse(m_downloader.response().body());
+    const int batchIssues = m_queue.batchSize();
+    if (!checkResponse(m_downloader.response().body())) {
+        if (m_error.empty())
+            sendBatch(false);
+        return;
+    }
+
+    m_retries = 0;
+    m_batchSizer.onSuccess(latency, batchIssues);
 
-    if (!m_error.empty() || !hasNextBatch())
+    if (!hasNextBatch())
         return;
 
-    json req;
-    req["query"] = nextBatch();
-    m_downloader.setRequestBody(req.dump());
-    m_downloader.sendRequest();
+    sendBatch(false);
 }
 
-void IssueUpdater::checkResponse(std::string_view response)
+void IssueUpdater::sendBatch(const bool onNewConnection)
 {
-    try {
-        const json data = json::parse(response);
-        if (data.contains("errors")) {
-            m_error = "The last API call returned an error:\n" + data.dump();
-            return;
-        }
-
-        const json issues = data["data"];
-        std::cout << "Updated " << countIssues(issues.size()) << " issues" << std::endl;
+    if (needsRevalidation()) {
+        sendRevalidation(onNewConnection);
+        return;
     }
-    catch (const std::exception &e) {
-        m_error += "Exception: ";
-        m_error += e.what();
+
+    // Only retries waiting for their backoff may be left
+    const auto wait = m_queue.waitTime(std::chrono::steady_clock::now());
+    m_batchSentTime = std::chrono::steady_clock::now() + wait;
+
+    json req;
+    req["query"] = nextBatch(m_batchSentTime);
+    std::string body = req.dump();
+    if (m_batchHasComment) {
+        // Splice the serialized comment in as {"query":"...","variables":{"body":"..."}}
+        body.pop_back();
+        body += ",\"variables\":";
+        body += m_commentVariables;
+        body += '}';
     }
+    m_downloader.setRequestBody(body);
+
+    if (onNewConnection)
+        m_downloader.resendOnNewConnection();
+    else if (wait > std::chrono::steady_clock::duration::zero())
+        m_downloader.sendRequestAfter(wait);
+    else
+        m_downloader.sendRequest();
+}
+
+// True if the next batch might take issues that weren't revalidated
+bool IssueUpdater::needsRevalidation() const
+{
+    return (m_revalidatedEnd < m_issues.size())
+            && ((m_queue.nextIssue() + static_cast<std::size_t>(m_batchSizer.size())) > m_revalidatedEnd);
 }
 
-std::string IssueUpdater::makeCommentAlias(const int counter, const std::string &issueID) const
+void IssueUpdater::sendRevalidation(const bool onNewConnection)
 {
-    const std::string part1 = ": addComment(input: {subjectId:\"";
-    const std::string part2 = "\", body:\"";
-    const std::string part3 = "\"}) { clientMutationId } ";
+    m_revalidatedBegin = std::max(m_revalidatedEnd, m_queue.nextIssue());
+    m_revalidatedEnd = std::min(m_revalidatedBegin + REVALIDATION_WINDOW, m_issues.size());
 
-    std::ostringstream buffer;
-    buffer << "comment" << counter << part1 << issueID << part2 << m_programOptions.comment << part3;
+    json ids = json::array();
+    for (std::size_t i = m_revalidatedBegin; i < m_revalidatedEnd; ++i)
+        ids.push_back(m_issues[i].ID);
 
-    return buffer.str();
+    m_isRevalidating = true;
+    m_downloader.setRequestBody(m_revalidationRequest.body({{"ids", ids}}));
+
+    if (onNewConnection)
+        m_downloader.resendOnNewConnection();
+    else
+        m_downloader.sendRequest();
 }
 
-std::string IssueUpdater::makeLabelAlias(const int counter, const std::string &issueID) const
+void IssueUpdater::onRevalidated()
 {
-    const std::string part1 = ": addLabelsToLabelable(input: {labelableId:\"";
-    const std::string part2 = "\", labelIds:[";
-    const std::string part3 = "]}) { clientMutationId } ";
+    m_isRevalidating = false;
 
-    std::ostringstream buffer;
-    buffer << "label" << counter << part1 << issueID << part2 << "\"" << m_labelID << "\"" << part3;
+    // The revalidation only saves mutations, so if it fails the issues are updated as gathered
+    const bool isBroken = !m_downloader.error().empty();
+    if (isBroken || (m_downloader.response().base().result() != http::status::ok)
+            || !revalidateIssues(m_downloader.response().body()))
+        std::cout << "Failed to revalidate the next issues, updating them as gathered" << std::endl;
 
-    return buffer.str();
+    if (hasNextBatch())
+        sendBatch(isBroken || !m_downloader.isKeptAlive());
 }
 
-std::string IssueUpdater::makeCloseAlias(const int counter, const std::string &issueID) const
+// Skips the issues that were deleted, closed or updated after the cutoff since they were gathered.
+// Returns false if the response can't be used.
+bool IssueUpdater::revalidateIssues(std::string_view response)
 {
-    const std::string part1 = ": closeIssue(input: {issueId:\"";
-    const std::string part2 = "\"}) { clientMutationId } ";
+    try {
+        const json data = json::parse(response);
+        // A deleted issue is reported as an error along with the data
+        if (!data.contains("data") || data["data"].is_null())
+            return false;
+
+        const json &nodes = data["data"]["nodes"];
+        if (nodes.size() != (m_revalidatedEnd - m_revalidatedBegin))
+            return false;
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            const json &node = nodes[i];
+            const bool isStale = node.is_null()
+                    || (node.value("state", std::string{}) != "OPEN")
+                    || (node.value("updatedAt", std::string{}) >= m_cutoff);
+
+            if (isStale) {
+                m_queue.skipIssue(m_revalidatedBegin + i);
+                ++m_staleIssues;
+            }
+        }
+    }
+    catch (const std::exception &) {
+        return false;
+    }
 
-    std::ostringstream buffer;
-    buffer << "close" << counter << part1 << issueID << part2;
+    return true;
+}
+
+// The batch got no result, so GitHub may have applied some of it. It is sent again only if
+// that does no harm. Otherwise the run stops, as the issues of the batch are in an unknown state.
+bool IssueUpdater::rewindUnansweredBatch(std::string_view reason)
+{
+    if (m_queue.batchSteps() & ~REPEATABLE_STEPS) {
+        m_error = "The batch failed (" + std::string(reason) + ") and may have been applied, so it can't be sent again";
+        return false;
+    }
 
-    return buffer.str();
+    return rewindBatch(reason);
 }
 
-std::string IssueUpdater::makeLockAlias(const int counter, const std::string &issueID) const
+// Puts the issues of the last batch back and shrinks the batch size
+bool IssueUpdater::rewindBatch(std::string_view reason)
 {
-    const std::string part1 = ": lockLockable(input: {lockableId:\"";
-    const std::string part2 = "\"}) { clientMutationId } ";
+    if (m_retries == MAX_RETRIES) {
+        m_error = "The batch failed " + std::to_string(MAX_RETRIES + 1) + " times. Last failure: " + std::string(reason);
+        return false;
+    }
 
-    std::ostringstream buffer;
-    buffer << "lock" << counter << part1 << issueID << part2;
+    ++m_retries;
+    m_batchSizer.onFailure();
+    m_queue.rewindBatch();
 
-    return buffer.str();
+    std::cout << "The batch failed (" << reason << "). Retrying with "
+              << m_batchSizer.size() << " issues per batch" << std::endl;
+    return true;
 }
 
-std::size_t IssueUpdater::countIssues(std::size_t responseItems) const
+// Returns false if the batch was rewound to be retried or m_error is set
+bool IssueUpdater::checkResponse(std::string_view response)
 {
-    std::size_t size = 1;
+    try {
+        const MutationResult mutationResult = readMutationResult(response);
+
+        // Each error points to the alias that failed with its path
+        std::unordered_map<std::string, std::string> aliasErrors;
+        if (mutationResult.hasErrors) {
+            // The errors are rare, so only then the whole response is parsed
+            const json data = json::parse(response);
+            if (!mutationResult.hasData) {
+                // GitHub answers with errors and no data when a query times out or costs too much.
+                // A query that costs too much is rejected before it runs, but a timed out one may have been applied in part.
+                const BatchFailure failure = classifyErrors(data["errors"]);
+                if (failure == BatchFailure::Timeout) {
+                    rewindUnansweredBatch("the query timed out");
+                    return false;
+                }
+
+                if (failure == BatchFailure::TooExpensive) {
+                    rewindBatch("the query was too expensive");
+                    return false;
+                }
+
+                m_error = "The last API call returned an error:\n" + data.dump();
+                return false;
+            }
+
+            for (const auto &error : data["errors"]) {
+                if (error.contains("path") && !error["path"].empty())
+                    aliasErrors[error["path"][0].get<std::string>()] = error.value("message", "");
+            }
+        }
+
+        const auto succeeded = [&mutationResult](const std::string &alias)
+        {
+            return mutationResult.succeededAliases.count(alias) > 0;
+        };
+        const MutationQueue::BatchResult result = m_queue.finishBatch(succeeded, std::chrono::steady_clock::now());
 
-    if (!m_programOptions.comment.empty())
-        ++size;
+        m_updatedIssues += result.completedIssues;
+        std::cout << "Updated " << result.completedIssues << " issues" << std::endl;
 
-    if (!m_labelID.empty())
-        ++size;
+        for (const std::string &alias : result.failedAliases)
+            std::cout << "The alias " << alias << " failed and will be retried: " << aliasErrors[alias] << std::endl;
 
-    if (m_programOptions.lock)
-        ++size;
+        for (const std::size_t issue : result.abandonedIssues)
+            m_failedIssues.push_back(m_issues[issue].ID);
+    }
+    catch (const std::exception &e) {
+        m_error += "Exception: ";
+        m_error += e.what();
+        return false;
+    }
+
+    return true;
+}
+
+void IssueUpdater::writeIssueAliases(std::string &buffer, const int counter, const MutationQueue::Item &item)
+{
+    if (item.steps & COMMENT_STEP)
+        m_batchHasComment = true;
 
-    return responseItems / size;
+    m_writeIssue(buffer, counter, m_issues[item.issue], item.steps, m_queue);
 }
@@ -22,39 +22,76 @@ SOFTWARE. */
 
 #pragma once
 
+#include <chrono>
 #include <string>
 #include <vector>
 
+#include <nlohmann/json.hpp>
+
+#include "batchsizer.h"
+#include "graphqlrequest.h"
+#include "mutationqueue.h"
+
+using json = nlohmann::json;
+
+struct IssueAttributes;
 class ProgramOptions;
 class PostDownloader;
 
 class IssueUpdater
 {
 public:
+    // Writes the aliases of the pending steps of an issue
+    using IssueWriter = void (*)(std::string &buffer, int counter, const IssueAttributes &issue,
+                                 MutationQueue::Steps steps, MutationQueue &queue);
+
     // The passed arguments must outlive the class instance
     explicit IssueUpdater(const ProgramOptions &programOptions, PostDownloader &downloader,
-                          const std::vector<std::string> &issues,
-                          std::string_view labelID, std::string &error);
+                          const std::vector<IssueAttributes> &issues, std::string &error);
 
     void run();
-    std::string nextBatch();
+    std::string nextBatch(MutationQueue::TimePoint sendTime);
     bool hasNextBatch();
 
+    // Used to estimate the cost of the batches
+    static int initialBatchSize();
+    static int mutationsPerIssue(const ProgramOptions &programOptions);
+
 private:
     void onFinishedPage();
 
-    void checkResponse(std::string_view response);
-    std::string makeCommentAlias(const int counter, const std::string &issueID) const;
-    std::string makeLabelAlias(const int counter, const std::string &issueID) const;
-    std::string makeCloseAlias(const int counter, const std::string &issueID) const;
-    std::string makeLockAlias(const int counter, const std::string &issueID) const;
-    std::size_t countIssues(std::size_t responseItems) const;
+    void sendBatch(const bool onNewConnection);
+    bool needsRevalidation() const;
+    void sendRevalidation(const bool onNewConnection);
+    void onRevalidated();
+    bool revalidateIssues(std::string_view response);
+    bool rewindUnansweredBatch(std::string_view reason);
+    bool rewindBatch(std::string_view reason);
+    bool checkResponse(std::string_view response);
+    void writeIssueAliases(std::string &buffer, const int counter, const MutationQueue::Item &item);
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
-    const std::vector<std::string> &m_issues;
-    const std::string m_labelID;
+    const std::vector<IssueAttributes> &m_issues;
     std::string &m_error;
-    int m_issuePos = 0;
-    bool m_hasNextBatch;
+    BatchSizer m_batchSizer;
+    MutationQueue m_queue;
+    // Instantiated for the actions of the options
+    const IssueWriter m_writeIssue;
+    std::chrono::steady_clock::time_point m_batchSentTime;
+    std::vector<std::string> m_failedIssues;
+    int m_retries = 0;
+    // Issues whose mutations all succeeded
+    int m_updatedIssues = 0;
+    // The $body variable, serialized once. Empty without a comment.
+    const std::string m_commentVariables;
+    bool m_batchHasComment = false;
+
+    // Issues [m_revalidatedBegin, m_revalidatedEnd) were revalidated last
+    const GraphQLRequest m_revalidationRequest;
+    const std::string m_cutoff;
+    std::size_t m_revalidatedBegin = 0;
+    std::size_t m_revalidatedEnd = 0;
+    bool m_isRevalidating = false;
+    int m_staleIssues = 0;
 };
@@ -0,0 +1,203 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+#ifdef USE_SIMDJSON
+#include <simdjson.h>
+#endif
+
+// Parses the API responses that are read in bulk (issue, label and mutation results).
+// They are walked with simdjson On-Demand when the program is built with USE_SIMDJSON,
+// eg with qmake "CONFIG+=simdjson", and with nlohmann::json otherwise.
+namespace JsonBackendDetail
+{
+    // Forwards the events of json::sax_parse and keeps the message of a syntax error
+    template <typename Sax>
+    class ErrorCapture
+    {
+    public:
+        ErrorCapture(Sax &sax, std::string &error)
+            : m_sax(sax)
+            , m_error(error)
+        {
+        }
+
+        bool null() { return m_sax.null(); }
+        bool boolean(bool value) { return m_sax.boolean(value); }
+        bool number_integer(nlohmann::json::number_integer_t value) { return m_sax.number_integer(value); }
+        bool number_unsigned(nlohmann::json::number_unsigned_t value) { return m_sax.number_unsigned(value); }
+        bool number_float(nlohmann::json::number_float_t value, const std::string &text) { return m_sax.number_float(value, text); }
+        bool string(std::string &value) { return m_sax.string(value); }
+        bool start_object(std::size_t size) { return m_sax.start_object(size); }
+        bool key(std::string &value) { return m_sax.key(value); }
+        bool end_object() { return m_sax.end_object(); }
+        bool start_array(std::size_t size) { return m_sax.start_array(size); }
+        bool end_array() { return m_sax.end_array(); }
+
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &e)
+        {
+            m_error = e.what();
+            return false;
+        }
+
+    private:
+        Sax &m_sax;
+        std::string &m_error;
+    };
+
+#ifdef USE_SIMDJSON
+    // Turns the values of the document into the SAX events, in document order.
+    // `text` is reused for every key and string.
+    template <typename Sax>
+    bool walk(simdjson::ondemand::value value, Sax &sax, std::string &text, simdjson::error_code &error)
+    {
+        simdjson::ondemand::json_type type;
+        if ((error = value.type().get(type)))
+            return false;
+
+        switch (type) {
+        case simdjson::ondemand::json_type::object: {
+            simdjson::ondemand::object object;
+            if ((error = value.get_object().get(object)) || !sax.start_object(std::size_t(-1)))
+                return false;
+
+            for (auto field : object) {
+                std::string_view key;
+                if ((error = field.unescaped_key().get(key)))
+                    return false;
+
+                text.assign(key);
+                simdjson::ondemand::value fieldValue;
+                if (!sax.key(text) || (error = field.value().get(fieldValue)) || !walk(fieldValue, sax, text, error))
+                    return false;
+            }
+            return sax.end_object();
+        }
+        case simdjson::ondemand::json_type::array: {
+            simdjson::ondemand::array array;
+            if ((error = value.get_array().get(array)) || !sax.start_array(std::size_t(-1)))
+                return false;
+
+            for (auto result : array) {
+                simdjson::ondemand::value element;
+                if ((error = result.get(element)) || !walk(element, sax, text, error))
+                    return false;
+            }
+            return sax.end_array();
+        }
+        case simdjson::ondemand::json_type::string: {
+            std::string_view string;
+            if ((error = value.get_string().get(string)))
+                return false;
+
+            text.assign(string);
+            return sax.string(text);
+        }
+        case simdjson::ondemand::json_type::number: {
+            simdjson::ondemand::number_type numberType;
+            if ((error = value.get_number_type().get(numberType)))
+                return false;
+
+            if (numberType == simdjson::ondemand::number_type::signed_integer) {
+                int64_t number = 0;
+                return !(error = value.get_int64().get(number)) && sax.number_integer(number);
+            }
+            if (numberType == simdjson::ondemand::number_type::unsigned_integer) {
+                uint64_t number = 0;
+                return !(error = value.get_uint64().get(number)) && sax.number_unsigned(number);
+            }
+
+            const std::string_view token = value.raw_json_token();
+            text.assign(token.substr(0, token.find_last_not_of(" \t\n\r") + 1));
+
+            // Like nlohmann, the integers that don't fit are read as floats
+            double number = 0;
+            if (numberType == simdjson::ondemand::number_type::big_integer)
+                number = std::strtod(text.c_str(), nullptr);
+            else if ((error = value.get_double().get(number)))
+                return false;
+
+            return sax.number_float(number, text);
+        }
+        case simdjson::ondemand::json_type::boolean: {
+            bool boolean = false;
+            return !(error = value.get_bool().get(boolean)) && sax.boolean(boolean);
+        }
+        case simdjson::ondemand::json_type::null: {
+            bool isNull = false;
+            if ((error = value.is_null().get(isNull)) || !isNull) {
+                error = error ? error : simdjson::N_ATOM_ERROR;
+                return false;
+            }
+            return sax.null();
+        }
+        default:
+            error = simdjson::INCORRECT_TYPE;
+            return false;
+        }
+    }
+#endif
+}
+
+// Feeds a whole document to a SAX handler with the interface of json::sax_parse().
+// Returns false on a syntax error, which is then in `error`, or when the handler stopped.
+// The document must be an object or an array, like every API response.
+template <typename Sax>
+bool parseJson(std::string_view document, Sax &sax, std::string &error)
+{
+#ifdef USE_SIMDJSON
+    // The parser and the padded copy keep their buffers from one response to the next
+    thread_local simdjson::ondemand::parser parser;
+    thread_local std::string buffer;
+    thread_local std::string text;
+
+    buffer.reserve(document.size() + simdjson::SIMDJSON_PADDING);
+    buffer.assign(document);
+
+    simdjson::error_code code = simdjson::SUCCESS;
+    simdjson::ondemand::document doc;
+    simdjson::ondemand::value root;
+    bool isParsed = !(code = parser.iterate(buffer.data(), buffer.size(), buffer.capacity()).get(doc))
+            && !(code = doc.get_value().get(root))
+            && JsonBackendDetail::walk(root, sax, text, code);
+
+    if (isParsed && !doc.at_end())
+        code = simdjson::TRAILING_CONTENT;
+
+    if (code) {
+        error = simdjson::error_message(code);
+        return false;
+    }
+    return isParsed;
+#else
+    JsonBackendDetail::ErrorCapture<Sax> capture(sax, error);
+    return nlohmann::json::sax_parse(document.begin(), document.end(), &capture);
+#endif
+}
@@ -0,0 +1,476 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A JSON parser that is fed a document in chunks as they arrive, eg from the socket.
+// It drives a SAX handler with the interface of json::sax_parse(), so every value
+// reaches the handler as soon as its last byte is fed. The nlohmann parser needs
+// the whole document up front. It accepts the documents that nlohmann accepts,
+// but only what the handlers of this program need is supported:
+// the element counts are unknown and parse_error() isn't called.
+template <typename Sax>
+class JsonPushParser
+{
+public:
+    explicit JsonPushParser(Sax &sax)
+        : m_sax(sax)
+    {
+    }
+
+    // Returns false on a syntax error or when the handler stopped the parsing.
+    // The rest of the document is then ignored.
+    bool feed(std::string_view chunk)
+    {
+        for (std::size_t i = 0; (i < chunk.size()) && !m_isStopped; ) {
+            switch (m_token) {
+            case Token::String:
+                i = readString(chunk, i);
+                break;
+            case Token::Escape:
+                readEscape(chunk[i++]);
+                break;
+            case Token::Unicode:
+                readUnicode(chunk[i++]);
+                break;
+            case Token::Literal:
+                if (isLiteralChar(chunk[i]))
+                    m_text += chunk[i++];
+                else
+                    endLiteral();
+                break;
+            case Token::None:
+                readStructural(chunk[i++]);
+                break;
+            }
+        }
+
+        m_offset += chunk.size();
+        return !m_isStopped;
+    }
+
+    // Returns false if the document is incomplete or wasn't parsed
+    bool finish()
+    {
+        if (!m_isStopped && (m_token == Token::Literal))
+            endLiteral();
+
+        if (!m_isStopped && ((m_token != Token::None) || (m_expect != Expect::Nothing)))
+            fail("unexpected end of input");
+
+        return !m_isStopped;
+    }
+
+    // Empty unless there was a syntax error
+    const std::string &error() const
+    {
+        return m_error;
+    }
+
+private:
+    enum class Expect { Value, ValueOrArrayEnd, KeyOrObjectEnd, Key, Colon, CommaOrEnd, Nothing };
+    enum class Token { None, String, Escape, Unicode, Literal };
+
+    std::size_t readString(std::string_view chunk, std::size_t i)
+    {
+        if ((m_highSurrogate != 0) && (chunk[i] != '\\')) {
+            fail("unpaired UTF-16 surrogate");
+            return chunk.size();
+        }
+
+        // The bulk of a response is string contents, so they are copied in runs
+        std::size_t end = i;
+        for (; end < chunk.size(); ++end) {
+            const auto c = static_cast<unsigned char>(chunk[end]);
+            if (m_utf8Remaining > 0) {
+                if ((c < m_utf8Lower) || (c > m_utf8Upper)) {
+                    fail("invalid UTF-8");
+                    return chunk.size();
+                }
+                --m_utf8Remaining;
+                m_utf8Lower = 0x80;
+                m_utf8Upper = 0xBF;
+            }
+            else if ((c == '"') || (c == '\\')) {
+                break;
+            }
+            else if (c < 0x20) {
+                fail("control character in a string");
+                return chunk.size();
+            }
+            else if ((c >= 0x80) && !startUtf8(c)) {
+                fail("invalid UTF-8");
+                return chunk.size();
+            }
+        }
+
+        m_text.append(chunk.substr(i, end - i));
+        if (end == chunk.size())
+            return chunk.size();
+
+        if (chunk[end] == '\\') {
+            m_token = Token::Escape;
+            return end + 1;
+        }
+
+        m_token = Token::None;
+        if (m_isKey) {
+            m_expect = Expect::Colon;
+            proceed(m_sax.key(m_text));
+        }
+        else {
+            proceed(m_sax.string(m_text));
+            afterValue();
+        }
+        m_text.clear();
+
+        return end + 1;
+    }
+
+    // Sets the continuation bytes that may follow the lead byte `c`, like nlohmann rejects
+    // overlong forms, surrogates and code points past U+10FFFF
+    bool startUtf8(unsigned char c)
+    {
+        m_utf8Lower = 0x80;
+        m_utf8Upper = 0xBF;
+
+        if ((c >= 0xC2) && (c <= 0xDF)) {
+            m_utf8Remaining = 1;
+        }
+        else if ((c >= 0xE0) && (c <= 0xEF)) {
+            m_utf8Remaining = 2;
+            if (c == 0xE0)
+                m_utf8Lower = 0xA0;
+            else if (c == 0xED)
+                m_utf8Upper = 0x9F;
+        }
+        else if ((c >= 0xF0) && (c <= 0xF4)) {
+            m_utf8Remaining = 3;
+            if (c == 0xF0)
+                m_utf8Lower = 0x90;
+            else if (c == 0xF4)
+                m_utf8Upper = 0x8F;
+        }
+        else {
+            return false;
+        }
+
+        return true;
+    }
+
+    void readEscape(char c)
+    {
+        if ((m_highSurrogate != 0) && (c != 'u')) {
+            fail("unpaired UTF-16 surrogate");
+            return;
+        }
+
+        m_token = Token::String;
+        switch (c) {
+        case '"': m_text += '"'; break;
+        case '\\': m_text += '\\'; break;
+        case '/': m_text += '/'; break;
+        case 'b': m_text += '\b'; break;
+        case 'f': m_text += '\f'; break;
+        case 'n': m_text += '\n'; break;
+        case 'r': m_text += '\r'; break;
+        case 't': m_text += '\t'; break;
+        case 'u':
+            m_token = Token::Unicode;
+            m_codeUnit = 0;
+            m_hexDigits = 0;
+            break;
+        default:
+            fail("invalid escape sequence");
+        }
+    }
+
+    void readUnicode(char c)
+    {
+        unsigned int digit = 0;
+        if ((c >= '0') && (c <= '9'))
+            digit = c - '0';
+        else if ((c >= 'a') && (c <= 'f'))
+            digit = c - 'a' + 10;
+        else if ((c >= 'A') && (c <= 'F'))
+            digit = c - 'A' + 10;
+        else {
+            fail("invalid \\u escape sequence");
+            return;
+        }
+
+        m_codeUnit = (m_codeUnit << 4) | digit;
+        if (++m_hexDigits < 4)
+            return;
+
+        m_token = Token::String;
+        if ((m_codeUnit >= 0xD800) && (m_codeUnit <= 0xDBFF)) {
+            if (m_highSurrogate != 0)
+                fail("unpaired UTF-16 surrogate");
+            m_highSurrogate = m_codeUnit;
+        }
+        else if ((m_codeUnit >= 0xDC00) && (m_codeUnit <= 0xDFFF)) {
+            if (m_highSurrogate == 0) {
+                fail("unpaired UTF-16 surrogate");
+                return;
+            }
+            appendUtf8(0x10000 + ((m_highSurrogate - 0xD800) << 10) + (m_codeUnit - 0xDC00));
+            m_highSurrogate = 0;
+        }
+        else {
+            appendUtf8(m_codeUnit);
+        }
+    }
+
+    void appendUtf8(unsigned int codePoint)
+    {
+        if (codePoint < 0x80) {
+            m_text += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800) {
+            m_text += static_cast<char>(0xC0 | (codePoint >> 6));
+            m_text += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000) {
+            m_text += static_cast<char>(0xE0 | (codePoint >> 12));
+            m_text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            m_text += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else {
+            m_text += static_cast<char>(0xF0 | (codePoint >> 18));
+            m_text += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            m_text += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            m_text += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    static bool isLiteralStart(char c)
+    {
+        return ((c >= '0') && (c <= '9')) || (c == '-') || (c == 't') || (c == 'f') || (c == 'n');
+    }
+
+    static bool isLiteralChar(char c)
+    {
+        return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'z')) || (c == '-') || (c == '+') || (c == '.') || (c == 'E');
+    }
+
+    // Numbers, true, false and null end at the first character that can't be part of them
+    void endLiteral()
+    {
+        m_token = Token::None;
+
+        if (m_text == "true")
+            proceed(m_sax.boolean(true));
+        else if (m_text == "false")
+            proceed(m_sax.boolean(false));
+        else if (m_text == "null")
+            proceed(m_sax.null());
+        else
+            endNumber();
+
+        m_text.clear();
+        if (!m_isStopped)
+            afterValue();
+    }
+
+    void endNumber()
+    {
+        const char *begin = m_text.data();
+        const char *end = begin + m_text.size();
+
+        bool isInteger = true;
+        if (!isNumber(m_text, isInteger)) {
+            fail("invalid number");
+            return;
+        }
+
+        if (isInteger && (m_text.front() == '-')) {
+            long long value = 0;
+            if (std::from_chars(begin, end, value).ec == std::errc{}) {
+                proceed(m_sax.number_integer(value));
+                return;
+            }
+        }
+        else if (isInteger) {
+            unsigned long long value = 0;
+            if (std::from_chars(begin, end, value).ec == std::errc{}) {
+                proceed(m_sax.number_unsigned(value));
+                return;
+            }
+        }
+
+        // Like nlohmann, the integers that don't fit are read as floats
+        proceed(m_sax.number_float(std::strtod(begin, nullptr), m_text));
+    }
+
+    // Checks the JSON grammar, which is stricter than strtod(): -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+    static bool isNumber(std::string_view text, bool &isInteger)
+    {
+        const auto isDigit = [](char c) { return (c >= '0') && (c <= '9'); };
+        const auto skipDigits = [&](std::size_t i) {
+            while ((i < text.size()) && isDigit(text[i]))
+                ++i;
+            return i;
+        };
+
+        std::size_t i = (!text.empty() && (text[0] == '-')) ? 1 : 0;
+        if ((i == text.size()) || !isDigit(text[i]))
+            return false;
+        i = (text[i] == '0') ? (i + 1) : skipDigits(i);
+
+        isInteger = true;
+        if ((i < text.size()) && (text[i] == '.')) {
+            isInteger = false;
+            const std::size_t fractionEnd = skipDigits(i + 1);
+            if (fractionEnd == (i + 1))
+                return false;
+            i = fractionEnd;
+        }
+
+        if ((i < text.size()) && ((text[i] == 'e') || (text[i] == 'E'))) {
+            isInteger = false;
+            ++i;
+            if ((i < text.size()) && ((text[i] == '+') || (text[i] == '-')))
+                ++i;
+            const std::size_t exponentEnd = skipDigits(i);
+            if (exponentEnd == i)
+                return false;
+            i = exponentEnd;
+        }
+
+        return i == text.size();
+    }
+
+    void readStructural(char c)
+    {
+        switch (c) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            return;
+        case '{':
+            if (!expectsValue())
+                break;
+            m_isArray.push_back(false);
+            m_expect = Expect::KeyOrObjectEnd;
+            proceed(m_sax.start_object(std::size_t(-1)));
+            return;
+        case '[':
+            if (!expectsValue())
+                break;
+            m_isArray.push_back(true);
+            m_expect = Expect::ValueOrArrayEnd;
+            proceed(m_sax.start_array(std::size_t(-1)));
+            return;
+        case '}':
+            if ((m_expect != Expect::KeyOrObjectEnd) && ((m_expect != Expect::CommaOrEnd) || m_isArray.back()))
+                break;
+            m_isArray.pop_back();
+            proceed(m_sax.end_object());
+            afterValue();
+            return;
+        case ']':
+            if ((m_expect != Expect::ValueOrArrayEnd) && ((m_expect != Expect::CommaOrEnd) || !m_isArray.back()))
+                break;
+            m_isArray.pop_back();
+            proceed(m_sax.end_array());
+            afterValue();
+            return;
+        case ',':
+            if (m_expect != Expect::CommaOrEnd)
+                break;
+            m_expect = m_isArray.back() ? Expect::Value : Expect::Key;
+            return;
+        case ':':
+            if (m_expect != Expect::Colon)
+                break;
+            m_expect = Expect::Value;
+            return;
+        case '"':
+            if ((m_expect == Expect::Key) || (m_expect == Expect::KeyOrObjectEnd))
+                m_isKey = true;
+            else if (expectsValue())
+                m_isKey = false;
+            else
+                break;
+            m_token = Token::String;
+            return;
+        default:
+            if (!expectsValue() || !isLiteralStart(c))
+                break;
+            m_token = Token::Literal;
+            m_text += c;
+            return;
+        }
+
+        fail(std::string("unexpected '") + c + "'");
+    }
+
+    bool expectsValue() const
+    {
+        return (m_expect == Expect::Value) || (m_expect == Expect::ValueOrArrayEnd);
+    }
+
+    void afterValue()
+    {
+        m_expect = m_isArray.empty() ? Expect::Nothing : Expect::CommaOrEnd;
+    }
+
+    void proceed(bool shouldProceed)
+    {
+        if (!shouldProceed)
+            m_isStopped = true;
+    }
+
+    void fail(const std::string &reason)
+    {
+        // The offset of the chunk, since the position inside it isn't tracked
+        m_error = "syntax error in the chunk at byte " + std::to_string(m_offset) + ": " + reason;
+        m_isStopped = true;
+    }
+
+    Sax &m_sax;
+    Expect m_expect = Expect::Value;
+    Token m_token = Token::None;
+    std::vector<bool> m_isArray;
+    // The string or literal being read
+    std::string m_text;
+    bool m_isKey = false;
+    unsigned int m_codeUnit = 0;
+    int m_hexDigits = 0;
+    unsigned int m_highSurrogate = 0;
+    // The continuation bytes of the UTF-8 character being read, and the range of the next one
+    int m_utf8Remaining = 0;
+    unsigned char m_utf8Lower = 0x80;
+    unsigned char m_utf8Upper = 0xBF;
+    std::size_t m_offset = 0;
+    bool m_isStopped = false;
+    std::string m_error;
+};
@@ -23,15 +23,20 @@ SOFTWARE. */
 #include "labelcreator.h"
 
 #include <iostream>
-#include <sstream>
 
 #include <nlohmann/json.hpp>
 
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    constexpr QueryTemplate LABEL_ALIAS{"label%n: createLabel(input: {color:\"FF0000\", name:\"%q\", repositoryId:\"%s\"}) { label { id } } "};
+}
+
 LabelCreator::LabelCreator(const ProgramOptions &programOptions, PostDownloader &downloader, std::string_view repoID,
                            std::string &error)
     : m_programOptions(programOptions)
@@ -46,9 +51,9 @@ void LabelCreator::run()
 {
     // Sample QraphQL string for the mutation with one alias named 'label0'
     // "mutation CreateLabel { label0: createLabel(input: {color:\"FF0000\", name:\"NAME\", repositoryId:\"REPO-ID\"}) { label { id } } }"
-    const std::string start = "mutation CreateLabel { ";
-    const std::string end = "}";
-    const std::string body = start + makeLabelAlias(0, m_programOptions.applyLabel) + end;
+    std::string body = "mutation CreateLabel { ";
+    writeLabelAlias(body, 0, m_programOptions.applyLabel);
+    body += "}";
 
     m_downloader.setFinishedHandler(beast::bind_front_handler(&LabelCreator::onFinishedPage, this));
 
@@ -97,17 +102,9 @@ void LabelCreator::gatherLabelID(std::string_view response)
     }
 }
 
-std::string LabelCreator::makeLabelAlias(const int counter, const std::string &name)
+void LabelCreator::writeLabelAlias(std::string &buffer, const int counter, const std::string &name)
 {
-    const std::string part1 = ": createLabel(input: {color:\"FF0000\", name:\"";
-    const std::string part2 = "\", repositoryId:\"";
-    const std::string part3 = "\"}) { label { id } } ";
-
-    std::ostringstream buffer;
-    buffer << "label" << counter;
-    buffer << part1 << name << part2 << m_repoID << part3;
-
-    return buffer.str();
+    writeQuery<LABEL_ALIAS>(buffer, counter, name, m_repoID);
 }
 
 std::string LabelCreator::labelId() const
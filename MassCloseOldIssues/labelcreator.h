@@ -43,7 +43,7 @@ private:
     void onFinishedPage();
 
     void gatherLabelID(std::string_view response);
-    std::string makeLabelAlias(const int counter, const std::string &name);
+    void writeLabelAlias(std::string &buffer, const int counter, const std::string &name);
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
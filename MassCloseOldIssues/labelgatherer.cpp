@@ -28,29 +28,70 @@ SOFTWARE. */
 
 #include <nlohmann/json.hpp>
 
+#include "bootstrapquery.h"
+#include "connectionreader.h"
 #include "postdownloader.h"
 #include "programoptions.h"
+#include "querytemplate.h"
 
 using json = nlohmann::json;
 
+namespace
+{
+    constexpr QueryTemplate LABELS_QUERY{"query($owner: String!, $name: String!, $after: String) { "
+                                         "repository(owner:$owner, name:$name) { id "
+                                         "labels(first:100, after:$after) { nodes { id name } pageInfo { endCursor hasNextPage } } } }"};
+    static_assert(LABELS_QUERY.isBalanced(), "Unbalanced GraphQL query");
+
+    constexpr QueryTemplate LOOKUP_FIELDS{"label(name:$label) { id name }"};
+    static_assert(LOOKUP_FIELDS.isBalanced(), "Unbalanced GraphQL query");
+
+    // A label of a page, read by readConnection()
+    struct LabelNode {
+        std::string id;
+        std::string name;
+
+        void set(const FieldPath &path, std::string &value)
+        {
+            if (path.is({"id"}))
+                id = std::move(value);
+            else if (path.is({"name"}))
+                name = std::move(value);
+        }
+
+        void set(const FieldPath &, long long)
+        {
+        }
+    };
+}
+
 LabelGatherer::LabelGatherer(const ProgramOptions &programOptions, PostDownloader &downloader, std::string &error)
     : m_programOptions(programOptions)
     , m_downloader(downloader)
     , m_error(error)
-    , m_body1part(generateBody1Part())
-    , m_body2part(") { nodes { id name } pageInfo { endCursor hasNextPage } } } }")
+    , m_request(LABELS_QUERY.text(), {{"owner", programOptions.repoOwner}, {"name", programOptions.repoName}})
 {
     m_error.clear();
 }
 
-void LabelGatherer::run()
+void LabelGatherer::run(std::string_view lookupResponse)
 {
-    m_downloader.setFinishedHandler(beast::bind_front_handler(&LabelGatherer::onFinishedPage, this));
+    // The label is looked up by name with one request, possibly the bootstrap query.
+    // A label that wasn't found doesn't exist and is left for the caller to create.
+    // All the labels are scanned only if the lookup response can't be used.
+    if (lookupResponse.empty()) {
+        BootstrapQuery query{m_programOptions};
+        addLookup(m_programOptions, query);
+        m_downloader.setRequestBody(query.body());
+    }
+    else {
+        if (lookupLabel(lookupResponse))
+            return;
 
-    json req;
-    req["query"] = m_body1part + m_body2part;
-    m_downloader.setRequestBody(req.dump());
+        startScan();
+    }
 
+    m_downloader.setFinishedHandler(beast::bind_front_handler(&LabelGatherer::onFinishedPage, this));
     m_downloader.run();
     m_downloader.setFinishedHandler(FinishedHandler{});
 }
@@ -62,6 +103,17 @@ void LabelGatherer::onFinishedPage()
         return;
     }
 
+    if (!m_isScanning) {
+        const bool isFound = (m_downloader.response().base().result() == http::status::ok)
+                && lookupLabel(m_downloader.response().body());
+
+        if (!isFound) {
+            startScan();
+            m_downloader.sendRequest();
+        }
+        return;
+    }
+
     if (m_downloader.response().base().result() != http::status::ok) {
         m_error = "The API HTTP response has status code: " + std::to_string(m_downloader.response().base().result_int());
         return;
@@ -70,46 +122,81 @@ void LabelGatherer::onFinishedPage()
     matchLabel(m_downloader.response().body());
 
     if (m_error.empty() && m_hasNext) {
-        const std::string body = m_body1part + ", after:\"" + m_cursor + "\"" + m_body2part;
-
-        json req;
-        req["query"] = body;
-        m_downloader.setRequestBody(req.dump());
+        m_downloader.setRequestBody(m_request.body({{"after", m_cursor}}));
         m_downloader.sendRequest();
 
         std::cout << "Downloading next Labels cursor: " << m_cursor << std::endl;
     }
 }
 
-void LabelGatherer::matchLabel(std::string_view response)
+void LabelGatherer::addLookup(const ProgramOptions &programOptions, BootstrapQuery &query)
+{
+    if (programOptions.applyLabel.empty())
+        return;
+
+    query.addVariable("$label: String!", programOptions.applyLabel);
+    query.addRepositoryFields(LOOKUP_FIELDS.text());
+}
+
+void LabelGatherer::startScan()
+{
+    m_isScanning = true;
+    m_downloader.setRequestBody(m_request.body());
+
+    std::cout << "Label '" << m_programOptions.applyLabel << "' couldn't be looked up by name, scanning all the labels" << std::endl;
+}
+
+// Returns false if the response can't be used, eg the query was rejected
+bool LabelGatherer::lookupLabel(std::string_view response)
 {
     try {
         const json data = json::parse(response);
-        if (data.contains("errors")) {
-            m_error = "The last API call returned an error:\n" + data.dump();
+        // A missing label comes back as "label": null without an error
+        if (!data.contains("data") || data["data"].is_null() || data.contains("errors"))
+            return false;
+
+        const json &repo = data["data"]["repository"];
+        m_repoId = repo["id"].get<std::string>();
+
+        const json &label = repo["label"];
+        if (label.is_object() && boost::algorithm::iequals(m_programOptions.applyLabel, label["name"].get<std::string>()))
+            m_labelId = label["id"].get<std::string>();
+    }
+    catch (const std::exception &) {
+        m_labelId.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void LabelGatherer::matchLabel(std::string_view response)
+{
+    try {
+        Connection<LabelNode> connection = readConnection<LabelNode>(response, {"data", "repository", "labels"});
+        if (connection.hasErrors) {
+            m_error = "The last API call returned an error:\n" + json::parse(response).dump();
             return;
         }
 
-        if (m_repoId.empty()) {
-            const json repo = data["data"]["repository"];
-            m_repoId = repo["id"].get<std::string>();
+        if (!connection.isFound) {
+            m_error = "The API response has no labels:\n" + std::string(response);
+            return;
         }
 
-        const json nodes = data["data"]["repository"]["labels"]["nodes"];
-        for (const auto &node : nodes) {
-            const std::string id = node["id"].get<std::string>();
-            const std::string name = node["name"].get<std::string>();
+        if (m_repoId.empty())
+            m_repoId = std::move(connection.parentID);
 
-            if (boost::algorithm::iequals(m_programOptions.applyLabel, name)) {
-                m_labelId = id;
+        for (LabelNode &node : connection.nodes) {
+            if (boost::algorithm::iequals(m_programOptions.applyLabel, node.name)) {
+                m_labelId = std::move(node.id);
                 m_hasNext = false;
                 return;
             }
         }
 
-        const json pageinfo = data["data"]["repository"]["labels"]["pageInfo"];
-        m_hasNext = pageinfo["hasNextPage"].get<bool>();
-        m_cursor = pageinfo["endCursor"].get<std::string>();
+        m_hasNext = connection.pageInfo.hasNext;
+        m_cursor = std::move(connection.pageInfo.cursor);
     }
     catch (const std::exception &e) {
         m_error += "Exception: ";
@@ -117,15 +204,6 @@ void LabelGatherer::matchLabel(std::string_view response)
     }
 }
 
-std::string LabelGatherer::generateBody1Part()
-{
-    return "query { repository(owner:\"" +
-            m_programOptions.repoOwner +
-            "\", name:\"" +
-            m_programOptions.repoName +
-            "\") { id labels(first:100";
-}
-
 std::string LabelGatherer::labelId() const
 {
     return m_labelId;
@@ -135,3 +213,8 @@ std::string LabelGatherer::repoId() const
 {
     return m_repoId;
 }
+
+std::string_view LabelGatherer::queryDocument()
+{
+    return LABELS_QUERY.text();
+}
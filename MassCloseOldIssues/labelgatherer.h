@@ -24,6 +24,9 @@ SOFTWARE. */
 
 #include <string>
 
+#include "graphqlrequest.h"
+
+class BootstrapQuery;
 class ProgramOptions;
 class PostDownloader;
 
@@ -33,24 +36,31 @@ public:
     // The passed arguments must outlive the class instance
     explicit LabelGatherer(const ProgramOptions &programOptions, PostDownloader &downloader, std::string &error);
 
-    void run();
+    // The response of the lookup may come from the bootstrap query
+    void run(std::string_view lookupResponse = {});
     std::string labelId() const;
     std::string repoId() const;
 
+    // The GraphQL document of each page of the scan, used to estimate its cost
+    static std::string_view queryDocument();
+    // Adds the lookup of the label by name to the bootstrap query
+    static void addLookup(const ProgramOptions &programOptions, BootstrapQuery &query);
+
 private:
     void onFinishedPage();
 
+    void startScan();
+    bool lookupLabel(std::string_view response);
     void matchLabel(std::string_view response);
-    std::string generateBody1Part();
 
     const ProgramOptions &m_programOptions;
     PostDownloader &m_downloader;
     std::string &m_error;
 
-    const std::string m_body1part;
-    const std::string m_body2part;
+    const GraphQLRequest m_request;
     std::string m_labelId;
     std::string m_repoId;
     std::string m_cursor;
     bool m_hasNext = false;
+    bool m_isScanning = false;
 };
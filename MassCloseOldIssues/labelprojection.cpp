@@ -0,0 +1,54 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "labelprojection.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Percentage of the issues whose labels should fit in a page
+    constexpr int COVERED_PERCENT = 95;
+}
+
+int LabelProjection::size() const
+{
+    return m_size;
+}
+
+void LabelProjection::observe(int labelCount)
+{
+    ++m_histogram[std::clamp(labelCount, 0, MAX_SIZE)];
+    ++m_observed;
+
+    // Smallest size that covers enough of the issues seen so far
+    const int target = ((m_observed * COVERED_PERCENT) + 99) / 100;
+    int covered = 0;
+    int size = 0;
+    for (; size < MAX_SIZE; ++size) {
+        covered += m_histogram[size];
+        if (covered >= target)
+            break;
+    }
+
+    m_size = std::max(size, MIN_SIZE);
+}
@@ -0,0 +1,46 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <array>
+
+// Picks how many labels are fetched with each issue of a page.
+// Most issues have a few labels, so fetching the first 100 of every issue
+// mostly inflates the node cost and the response. The size covers most of the
+// label counts seen so far and the few issues with more labels are completed
+// later with a follow-up query.
+class LabelProjection
+{
+public:
+    static constexpr int MIN_SIZE = 4;
+    static constexpr int MAX_SIZE = 100;
+
+    int size() const;
+    // Records the totalCount of the labels of an issue
+    void observe(int labelCount);
+
+private:
+    std::array<int, MAX_SIZE + 1> m_histogram{};
+    int m_observed = 0;
+    int m_size = MIN_SIZE;
+};
@@ -0,0 +1,67 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "labeltable.h"
+
+LabelTable &LabelTable::instance()
+{
+    static LabelTable table;
+    return table;
+}
+
+LabelHandle LabelTable::internID(std::string_view id)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.intern(id);
+}
+
+LabelHandle LabelTable::internName(std::string_view name)
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+
+    // Only ASCII is folded, like boost::iequals() with the default locale
+    m_foldedName.assign(name);
+    for (char &c : m_foldedName) {
+        if ((c >= 'A') && (c <= 'Z'))
+            c = static_cast<char>(c - 'A' + 'a');
+    }
+
+    return m_names.intern(m_foldedName);
+}
+
+std::string_view LabelTable::id(LabelHandle handle) const
+{
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ids.texts[handle];
+}
+
+LabelHandle LabelTable::Strings::intern(std::string_view text)
+{
+    const auto iter = handles.find(text);
+    if (iter != handles.cend())
+        return iter->second;
+
+    const auto handle = static_cast<LabelHandle>(texts.size());
+    texts.emplace_back(text);
+    handles.emplace(texts.back(), handle);
+    return handle;
+}
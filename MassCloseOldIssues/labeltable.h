@@ -0,0 +1,187 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// A dense number that stands for a label ID or name of the LabelTable
+using LabelHandle = std::uint32_t;
+
+constexpr LabelHandle NO_LABEL = std::numeric_limits<LabelHandle>::max();
+
+// Interns the label IDs and names, which tens of thousands of issues share, into dense handles.
+// The issues keep the handles instead of strings and the labels are compared as integers.
+// It is shared by the whole process, including the shards that gather in parallel.
+class LabelTable
+{
+public:
+    static LabelTable &instance();
+
+    LabelHandle internID(std::string_view id);
+    // The names are case insensitive, like on GitHub. The handles of names and IDs are unrelated.
+    LabelHandle internName(std::string_view name);
+    // The ID of a handle from internID()
+    std::string_view id(LabelHandle handle) const;
+
+private:
+    struct Strings {
+        LabelHandle intern(std::string_view text);
+
+        // The views of the map point into the deque, which doesn't move its elements
+        std::deque<std::string> texts;
+        std::unordered_map<std::string_view, LabelHandle> handles;
+    };
+
+    LabelTable() = default;
+
+    mutable std::mutex m_mutex;
+    Strings m_ids;
+    Strings m_names;
+    // Reused to fold the case of the names
+    std::string m_foldedName;
+};
+
+// The labels of an issue. The few that most issues have are stored in place, more go to the heap.
+class LabelHandles
+{
+public:
+    LabelHandles() = default;
+
+    LabelHandles(const LabelHandles &other)
+    {
+        assign(other.begin(), other.size());
+    }
+
+    LabelHandles(LabelHandles &&other) noexcept
+    {
+        take(other);
+    }
+
+    ~LabelHandles()
+    {
+        release();
+    }
+
+    LabelHandles &operator=(const LabelHandles &other)
+    {
+        if (this != &other) {
+            LabelHandles copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    LabelHandles &operator=(LabelHandles &&other) noexcept
+    {
+        if (this != &other) {
+            release();
+            take(other);
+        }
+        return *this;
+    }
+
+    void push_back(LabelHandle handle)
+    {
+        if (m_size == m_capacity)
+            grow();
+
+        data()[m_size++] = handle;
+    }
+
+    const LabelHandle *begin() const { return isOnHeap() ? m_heap : m_inline; }
+    const LabelHandle *end() const { return begin() + m_size; }
+    std::size_t size() const { return m_size; }
+
+    bool contains(LabelHandle handle) const
+    {
+        return std::find(begin(), end(), handle) != end();
+    }
+
+private:
+    // The heap pointer takes the space of two of them
+    static constexpr std::uint32_t INLINE_CAPACITY = 6;
+
+    bool isOnHeap() const { return m_capacity > INLINE_CAPACITY; }
+    LabelHandle *data() { return isOnHeap() ? m_heap : m_inline; }
+
+    void grow()
+    {
+        const std::uint32_t capacity = 2 * m_capacity;
+        LabelHandle *heap = new LabelHandle[capacity];
+        std::copy(begin(), end(), heap);
+        if (isOnHeap())
+            delete[] m_heap;
+
+        m_heap = heap;
+        m_capacity = capacity;
+    }
+
+    void assign(const LabelHandle *handles, std::size_t size)
+    {
+        while (m_capacity < size)
+            grow();
+
+        std::copy(handles, handles + size, data());
+        m_size = static_cast<std::uint32_t>(size);
+    }
+
+    // Frees the heap array and leaves the instance empty
+    void release()
+    {
+        if (isOnHeap())
+            delete[] m_heap;
+
+        m_size = 0;
+        m_capacity = INLINE_CAPACITY;
+    }
+
+    // Leaves `other` empty
+    void take(LabelHandles &other)
+    {
+        m_size = other.m_size;
+        m_capacity = other.m_capacity;
+        if (other.isOnHeap())
+            m_heap = other.m_heap;
+        else
+            std::copy(other.m_inline, other.m_inline + other.m_size, m_inline);
+
+        other.m_size = 0;
+        other.m_capacity = INLINE_CAPACITY;
+    }
+
+    std::uint32_t m_size = 0;
+    std::uint32_t m_capacity = INLINE_CAPACITY;
+    union {
+        LabelHandle m_inline[INLINE_CAPACITY];
+        LabelHandle *m_heap;
+    };
+};
@@ -20,67 +20,127 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE. */
 
+#include <algorithm>
 #include <iostream>
+#include <thread>
 
+#include "bootstrapquery.h"
+#include "executionplanner.h"
+#include "issueattributes.h"
 #include "issuegatherer.h"
+#include "issueshardplanner.h"
 #include "issueupdater.h"
 #include "labelcreator.h"
 #include "labelgatherer.h"
+#include "labeltable.h"
 #include "postdownloader.h"
 #include "programoptions.h"
 
-int main(int argc, char *argv[])
+std::vector<IssueAttributes> gatherShards(const ProgramOptions &options, const std::vector<CreatedRange> &shards, std::string &error)
 {
-    std::string error;
-    const ProgramOptions options = ProgramOptions::parseCmdLine(argc, argv, error);
-    if (!error.empty()) {
-        std::cout << error << std::endl;
-        return -1;
+    std::vector<std::vector<IssueAttributes>> shardIssues(shards.size());
+    std::vector<std::string> shardErrors(shards.size());
+    std::vector<std::thread> threads;
+
+    // Each shard uses its own connection and io_context
+    for (std::vector<CreatedRange>::size_type i = 0; i < shards.size(); ++i) {
+        threads.emplace_back([&options, &shards, &shardIssues, &shardErrors, i]()
+        {
+            PostDownloader downloader(options);
+            if (!downloader.error().empty()) {
+                shardErrors[i] = downloader.error();
+                return;
+            }
+
+            // The arguments must outlive the class instance
+            IssueGatherer issueGatherer{options, downloader, shardIssues[i], shardErrors[i], shards[i]};
+            // run() runs the io_context and blocks
+            issueGatherer.run();
+        });
     }
 
-    std::vector<std::string> issues;
+    for (auto &thread : threads)
+        thread.join();
 
-    PostDownloader downloader(options);
-    if (!downloader.error().empty()) {
-        std::cout << downloader.error() << std::endl;
-        return -1;
+    std::vector<IssueAttributes> issues;
+    for (std::vector<CreatedRange>::size_type i = 0; i < shards.size(); ++i) {
+        if (!shardErrors[i].empty()) {
+            error = "Shard " + std::to_string(i) + ": " + shardErrors[i];
+            return {};
+        }
+
+        issues.insert(issues.end(), std::make_move_iterator(shardIssues[i].begin()), std::make_move_iterator(shardIssues[i].end()));
     }
 
+    return issues;
+}
+
+// Gathers the issues of options.repoName and appends them to `issues` along with the label to apply.
+// The issues of the previous repos in `issues` count against the rate limit points of the updates.
+void gatherRepo(const ProgramOptions &options, PostDownloader &downloader, std::vector<IssueAttributes> &issues, std::string &error)
+{
+    // The first issue page and the label lookup are sent along with the probe of the planner
+    BootstrapQuery bootstrap{options};
+    IssueGatherer::addFirstPage(options, bootstrap);
+    LabelGatherer::addLookup(options, bootstrap);
+
     // The arguments must outlive the class instance
-    IssueGatherer issueGatherer{options, downloader, issues, error};
+    ExecutionPlanner planner{options, downloader, bootstrap, error};
     // run() runs the io_context and blocks
-    issueGatherer.run();
+    planner.run();
 
-    if (!error.empty()) {
-        std::cout << error << std::endl;
-        return -1;
+    if (!error.empty())
+        return;
+
+    std::vector<IssueAttributes> repoIssues;
+    if (options.shards > 1) {
+        // The arguments must outlive the class instance
+        IssueShardPlanner shardPlanner{options, downloader, error};
+        // run() runs the io_context and blocks
+        shardPlanner.run();
+
+        if (error.empty())
+            repoIssues = gatherShards(options, shardPlanner.shards(), error);
+    }
+    else {
+        // The arguments must outlive the class instance
+        IssueGatherer issueGatherer{options, downloader, repoIssues, error};
+        // run() runs the io_context and blocks
+        issueGatherer.run(planner.bootstrapResponse());
     }
 
-    if (issues.size() == 0) {
+    if (!error.empty())
+        return;
+
+    if (repoIssues.size() == 0) {
         std::cout << "No issues were found" << std::endl;
-        return 0;
+        return;
     }
 
-    std::cout << issues.size() << " issues were found" << std::endl;
+    std::cout << repoIssues.size() << " issues were found" << std::endl;
+
+    // Leave the rest for a later run instead of running out of points halfway
+    const std::size_t planned = issues.size();
+    const std::size_t fitting = std::max(planner.planUpdates(planned + repoIssues.size()), planned) - planned;
+    repoIssues.erase(repoIssues.begin() + fitting, repoIssues.end());
 
     std::string labelID;
     if (!options.applyLabel.empty()) {
         // The arguments must outlive the class instance
         LabelGatherer labelGatherer{options, downloader, error};
         // run() runs the io_context and blocks
-        labelGatherer.run();
+        labelGatherer.run(planner.bootstrapResponse());
 
-        if (!error.empty()) {
-            std::cout << error << std::endl;
-            return -1;
-        }
+        if (!error.empty())
+            return;
 
         if (labelGatherer.labelId().empty()) {
             std::cout << "Need to create label \'" + options.applyLabel + "\'" << std::endl;
 
+            // The run stops before any mutation
             if (options.dryRun) {
-                std::cout << "This is a dry run, stopping now." << std::endl;
-                return 0;
+                issues.insert(issues.end(), std::make_move_iterator(repoIssues.begin()), std::make_move_iterator(repoIssues.end()));
+                return;
             }
 
             // The arguments must outlive the class instance
@@ -88,14 +148,12 @@ int main(int argc, char *argv[])
             // run() runs the io_context and blocks
             lblCreator.run();
 
-            if (!error.empty()) {
-                std::cout << error << std::endl;
-                return -1;
-            }
+            if (!error.empty())
+                return;
 
             if (lblCreator.labelId().empty()) {
-                std::cout << "The label wasn't created" << std::endl;
-                return -1;
+                error = "The label wasn't created";
+                return;
             }
 
             labelID = lblCreator.labelId();
@@ -105,13 +163,60 @@ int main(int argc, char *argv[])
         }
     }
 
+    const LabelHandle labelHandle = labelID.empty() ? NO_LABEL : LabelTable::instance().internID(labelID);
+    for (IssueAttributes &issue : repoIssues) {
+        issue.labelID = labelHandle;
+        issues.push_back(std::move(issue));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string error;
+    const ProgramOptions options = ProgramOptions::parseCmdLine(argc, argv, error);
+    if (!error.empty()) {
+        std::cout << error << std::endl;
+        return -1;
+    }
+
+    PostDownloader downloader(options);
+    if (!downloader.error().empty()) {
+        std::cout << downloader.error() << std::endl;
+        return -1;
+    }
+
+    // The issues of all the repos are updated together, since the aliases of a
+    // mutation can target issues of any repo. So the batches stay full even
+    // when each repo only has a few issues left.
+    std::vector<IssueAttributes> issues;
+    for (const std::string &repoName : options.repoNames) {
+        ProgramOptions repoOptions = options;
+        repoOptions.repoName = repoName;
+
+        if (options.repoNames.size() > 1)
+            std::cout << "Repo " << options.repoOwner << "/" << repoName << ":" << std::endl;
+
+        gatherRepo(repoOptions, downloader, issues, error);
+
+        if (!error.empty()) {
+            std::cout << error << std::endl;
+            return -1;
+        }
+    }
+
+    if (issues.size() == 0)
+        return 0;
+
+    if (options.repoNames.size() > 1)
+        std::cout << issues.size() << " issues of " << options.repoNames.size() << " repos will be updated" << std::endl;
+
     if (options.dryRun) {
         std::cout << "This is a dry run, stopping now." << std::endl;
         return 0;
     }
 
     // The arguments must outlive the class instance
-    IssueUpdater issueUpdater{options, downloader, issues, labelID, error};
+    IssueUpdater issueUpdater{options, downloader, issues, error};
     // run() runs the io_context and blocks
     issueUpdater.run();
 
@@ -0,0 +1,101 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Queue of the issues to update with batched mutations.
+// Each issue has a set of steps (eg comment, close) and every alias of a
+// batch carries some of the steps of one issue. The steps whose aliases fail
+// are retried in a later batch after a backoff, so one bad issue doesn't
+// affect the rest of its batch. A batch that fails as a whole is put back.
+class MutationQueue
+{
+public:
+    using Steps = unsigned int;
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    struct Item {
+        std::size_t issue;
+        // The steps that still need to be done
+        Steps steps;
+        int attempts = 0;
+        TimePoint notBefore{};
+    };
+
+    struct BatchResult {
+        // Issues whose steps are all done
+        int completedIssues = 0;
+        std::vector<std::string> failedAliases;
+        // Issues that ran out of attempts
+        std::vector<std::size_t> abandonedIssues;
+    };
+
+    explicit MutationQueue(std::size_t issues, Steps steps, int maxAttempts);
+
+    // No more items to send. The current batch doesn't count.
+    bool empty() const;
+    // How long until the next item can be sent
+    std::chrono::steady_clock::duration waitTime(TimePoint now) const;
+    // The first issue that was never taken. Equals the number of issues when all of them were.
+    std::size_t nextIssue() const;
+    // Removes an issue that was never taken, eg because it changed since it was gathered
+    void skipIssue(std::size_t issue);
+
+    // Moves the next item that is ready at `now` into the current batch.
+    // Its alias counter is its position in the batch. Returns nullptr if no item is ready.
+    const Item *takeReady(TimePoint now);
+    // Records that `alias` carries `steps` of the last taken item.
+    // An empty alias marks steps that turned out to need no mutation.
+    void addAlias(std::string alias, Steps steps);
+    int batchSize() const;
+    // The steps that the aliases of the current batch carry
+    Steps batchSteps() const;
+
+    // Puts the current batch back in front of the queue as it was
+    void rewindBatch();
+    // Ends the current batch and requeues the steps of the aliases that didn't succeed
+    BatchResult finishBatch(const std::function<bool (const std::string &alias)> &succeeded, TimePoint now);
+
+private:
+    struct Alias {
+        std::string name;
+        std::size_t batchIndex;
+        Steps steps;
+    };
+
+    const std::size_t m_issues;
+    const Steps m_steps;
+    const int m_maxAttempts;
+    std::size_t m_nextIssue = 0;
+    std::vector<bool> m_isSkipped;
+    // Items put back or waiting for a retry. They go before the remaining issues.
+    std::deque<Item> m_pending;
+    std::vector<Item> m_batch;
+    std::vector<Alias> m_aliases;
+};
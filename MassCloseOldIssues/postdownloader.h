@@ -22,9 +22,12 @@ SOFTWARE. */
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <string>
 #include <string_view>
 
+#include <boost/asio/steady_timer.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/ssl.hpp>
@@ -38,6 +41,8 @@ using tcp = boost::asio::ip::tcp;
 struct ProgramOptions;
 
 using FinishedHandler = std::function<void()>;
+// Gets the part of the response body that just arrived
+using BodyHandler = std::function<void(std::string_view chunk)>;
 
 // Performs an HTTP POST and stores the response
 class PostDownloader
@@ -48,13 +53,23 @@ public:
 
     // Start the asynchronous operation
     void run();
+    // Like run(), for a request that the caller already started, eg with sendRequestAfter()
+    void runSent();
 
     std::string_view error() const;
+    // Called when a response arrived or the request failed with a transport error
     void setFinishedHandler(FinishedHandler handler);
+    // Only the bodies of responses with status 200 are passed, before the finished handler is called
+    void setBodyHandler(BodyHandler handler);
     void setRequestBody(std::string_view body);
     const http::response<http::string_body>& response() const;
     bool isKeptAlive() const;
     void sendRequest();
+    // Sends the request once the delay expires, eg to back off before a retry
+    void sendRequestAfter(std::chrono::steady_clock::duration delay);
+    // Drops the current connection and sends the request again on a new one.
+    // Use it after the connection broke (eg a timeout) while inside a finished handler.
+    void resendOnNewConnection();
     void closeConnection();
 
 private:
@@ -63,10 +78,15 @@ private:
     void onConnect(beast::error_code ec, tcp::resolver::results_type::endpoint_type);
     void onHandshake(beast::error_code ec);
     void onWrite(beast::error_code ec, std::size_t);
-    void onRead(beast::error_code ec, std::size_t);
+    void onReadSome(beast::error_code ec, std::size_t);
+    void readSome();
     void onShutdown(beast::error_code ec);
+    void onDelay(beast::error_code ec);
 
     void initializeConnection();
+    void resolve();
+    void fail(std::string error);
+    void failConnection(std::string error);
 
     // Private members
     // The io_context is required for all I/O
@@ -77,12 +97,19 @@ private:
     beast::flat_buffer m_buffer;
     http::request<http::string_body> m_request;
     http::response<http::string_body> m_response;
+    // The response is read piece by piece, so the body handler sees the body as it arrives
+    std::optional<http::response_parser<http::string_body>> m_parser;
+    // The size of the body that was passed to the body handler
+    std::size_t m_handledBodySize = 0;
     tcp::resolver m_resolver;
-    beast::ssl_stream<beast::tcp_stream> m_stream;
+    net::steady_timer m_timer;
+    std::optional<beast::ssl_stream<beast::tcp_stream>> m_stream;
 
     std::string m_error;
     std::string m_body;
     FinishedHandler m_finishedHanlder;
+    BodyHandler m_bodyHandler;
 
     bool m_isOpenConnection = false;
+    bool m_sendAfterConnect = false;
 };
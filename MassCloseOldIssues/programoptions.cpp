@@ -42,7 +42,7 @@ ProgramOptions ProgramOptions::parseCmdLine(int &argc, char *argv[], std::string
     po::options_description required("Required");
     required.add_options()
             ("repo-owner", po::value<std::string>(&opt.repoOwner)->required(), "Set the repo owner (github repos are in the format owner/name)")
-            ("repo-name", po::value<std::string>(&opt.repoName)->required(), "Set the repo name (github repos are in the format owner/name)")
+            ("repo-name", po::value<std::vector<std::string>>(&opt.repoNames)->required(), "Set the repo name (github repos are in the format owner/name). You can pass this argument multiple times to process several repos of the owner in one run.")
             ("auth-token", po::value<std::string>(&opt.authToken)->required(), "Set your Personal Access Token (OAuth token might work too)")
             ("user-agent", po::value<std::string>(&opt.userAgent)->required(), "Set the user-agent. Ideally set an email so GitHub can contact you if something is wrong.")
             ("cutoff-timepoint", po::value<std::string>()->required(), "Issues that haven't been updated until the timepoint are closed. The timepoint must be a UTC extended format ISO-8601 string.")
@@ -54,6 +54,8 @@ ProgramOptions ProgramOptions::parseCmdLine(int &argc, char *argv[], std::string
             ("comment", po::value<std::string>(&opt.comment), "Leave a comment in the issues that are going to be closed.")
             ("skip-label", po::value<std::vector<std::string>>(&opt.labelList), "Issues with this label are excluded from being closed. You can pass this argument multiple times.")
             ("lock", po::bool_switch(&opt.lock), "Lock the issues in addition to closing them.")
+            ("use-search", po::bool_switch(&opt.useSearch), "Find the issues with the search API. GitHub filters them by the cutoff timepoint and most skip labels, so much fewer pages are downloaded.")
+            ("shards", po::value<int>(&opt.shards)->default_value(1), "Split the creation dates of the issues into this many ranges with about the same number of issues and search them in parallel. It implies --use-search.")
             ("dry-run", po::bool_switch(&opt.dryRun), "Don't perform any changes/mutations on the given repo. Perform only the queries and print relevant information.")
     ;
 
@@ -78,6 +80,15 @@ ProgramOptions ProgramOptions::parseCmdLine(int &argc, char *argv[], std::string
             error = "Failed to parsed the value of the cutoff-timepoint parameter";
     }
 
+    if (!opt.repoNames.empty())
+        opt.repoName = opt.repoNames.front();
+
+    if (error.empty() && (opt.shards < 1))
+        error = "The number of shards must be at least 1";
+
+    if (opt.shards > 1)
+        opt.useSearch = true;
+
     // Always print the help message if the switch is present regardless of other errors
     if (vm.count("help")) {
         std::ostringstream stream;
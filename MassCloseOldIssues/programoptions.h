@@ -31,14 +31,18 @@ struct ProgramOptions {
     static ProgramOptions parseCmdLine(int &argc, char *argv[], std::string &error);
 
     std::string repoOwner;
+    // The repo that is processed, one of repoNames
     std::string repoName;
+    std::vector<std::string> repoNames;
     std::string authToken;
     std::string userAgent;    
     std::string applyLabel;
     std::string comment;
     std::vector<std::string> labelList;
     std::chrono::time_point<std::chrono::system_clock, std::chrono::milliseconds> cutoffTimePoint;
+    int shards;
     bool lock;
+    bool useSearch;
     bool dryRun;
 };
 
@@ -0,0 +1,41 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <string_view>
+
+// The cost of a GraphQL query according to GitHub's resource limitation rules
+struct QueryCost {
+    // Maximum number of nodes the query can return. GitHub rejects queries above 500000.
+    long long nodes = 0;
+    // Number of requests needed to fulfill every connection, assuming each one
+    // returns as many nodes as its `first`/`last` argument allows
+    long long requests = 0;
+
+    // Rate limit points: requests / 100, rounded, with a minimum of 1
+    int points() const;
+};
+
+// Estimates the cost of a query document. Connections whose page size is a
+// variable are assumed to request the maximum of 100 nodes.
+QueryCost estimateQueryCost(std::string_view document);
@@ -0,0 +1,228 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "stringescape.h"
+
+// A GraphQL document (or a part of it) that is fixed at build time apart from a few slots.
+// A slot is written as '%' followed by its type:
+//   %n  an integer, eg the alias counter
+//   %s  a string that is copied verbatim, eg a node ID
+//   %q  a string that is escaped for a string literal, eg a title. Put it between quotes.
+//
+// The constructor validates the slots. Declare templates `constexpr` so a malformed
+// template fails the build instead of the run. Templates can be concatenated with `+`
+// at compile time and are written with writeQuery().
+template <std::size_t N>
+class QueryTemplate
+{
+public:
+    static constexpr std::size_t MAX_SLOTS = 8;
+
+    constexpr QueryTemplate(const char (&text)[N])
+    {
+        for (std::size_t i = 0; i < N; ++i)
+            m_text[i] = text[i];
+
+        if (m_text[N - 1] != '\0')
+            throw std::logic_error("QueryTemplate: the text isn't null terminated");
+
+        for (std::size_t i = 0; i < (N - 1); ++i) {
+            if (m_text[i] != '%')
+                continue;
+
+            const char type = m_text[i + 1];
+            if ((type != 'n') && (type != 's') && (type != 'q'))
+                throw std::logic_error("QueryTemplate: unknown slot type");
+            if (m_slotCount == MAX_SLOTS)
+                throw std::logic_error("QueryTemplate: too many slots");
+
+            m_slotPos[m_slotCount] = i;
+            ++m_slotCount;
+            ++i;
+        }
+    }
+
+    constexpr std::string_view text() const
+    {
+        return {m_text, N - 1};
+    }
+
+    constexpr std::size_t slotCount() const
+    {
+        return m_slotCount;
+    }
+
+    constexpr char slotType(std::size_t slot) const
+    {
+        return m_text[m_slotPos[slot] + 1];
+    }
+
+    // The fixed text that precedes `slot`. Pass slotCount() to get the text after the last slot.
+    constexpr std::string_view chunk(std::size_t slot) const
+    {
+        const std::size_t begin = (slot == 0) ? 0 : (m_slotPos[slot - 1] + 2);
+        const std::size_t end = (slot == m_slotCount) ? (N - 1) : m_slotPos[slot];
+        return text().substr(begin, end - begin);
+    }
+
+    // Size of the text without the slot markers
+    constexpr std::size_t fixedSize() const
+    {
+        return (N - 1) - (2 * m_slotCount);
+    }
+
+    // True if every bracket is closed and every string literal is terminated
+    constexpr bool isBalanced() const
+    {
+        char stack[N] = {};
+        std::size_t depth = 0;
+        bool inString = false;
+
+        for (std::size_t i = 0; i < (N - 1); ++i) {
+            const char ch = m_text[i];
+
+            if (inString) {
+                if (ch == '\\')
+                    ++i;
+                else if (ch == '"')
+                    inString = false;
+                continue;
+            }
+
+            switch (ch) {
+            case '"':
+                inString = true;
+                break;
+            case '(':
+                stack[depth++] = ')';
+                break;
+            case '{':
+                stack[depth++] = '}';
+                break;
+            case '[':
+                stack[depth++] = ']';
+                break;
+            case ')':
+            case '}':
+            case ']':
+                if ((depth == 0) || (stack[--depth] != ch))
+                    return false;
+                break;
+            default:
+                break;
+            }
+        }
+
+        return !inString && (depth == 0);
+    }
+
+private:
+    char m_text[N] = {};
+    std::size_t m_slotPos[MAX_SLOTS] = {};
+    std::size_t m_slotCount = 0;
+};
+
+template <std::size_t N, std::size_t M>
+constexpr QueryTemplate<N + M - 1> operator+(const QueryTemplate<N> &left, const QueryTemplate<M> &right)
+{
+    char text[N + M - 1] = {};
+    for (std::size_t i = 0; i < (N - 1); ++i)
+        text[i] = left.text()[i];
+    for (std::size_t i = 0; i < (M - 1); ++i)
+        text[N - 1 + i] = right.text()[i];
+
+    return QueryTemplate<N + M - 1>(text);
+}
+
+namespace QueryTemplateDetail
+{
+    template <typename T>
+    constexpr bool isSlotValue(char type)
+    {
+        if constexpr (std::is_integral_v<T>)
+            return type == 'n';
+        else
+            return ((type == 's') || (type == 'q')) && std::is_convertible_v<const T &, std::string_view>;
+    }
+
+    // An escaped string might need more, but rarely does
+    template <typename T>
+    std::size_t slotSize(const T &value)
+    {
+        if constexpr (std::is_integral_v<T>)
+            return 20; // enough for any 64bit integer
+        else
+            return std::string_view(value).size();
+    }
+
+    template <char Type, typename T>
+    void writeSlot(std::string &buffer, const T &value)
+    {
+        if constexpr (std::is_integral_v<T>) {
+            char digits[24];
+            const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+            buffer.append(digits, result.ptr);
+        }
+        else if constexpr (Type == 'q') {
+            appendEscaped(buffer, std::string_view(value));
+        }
+        else {
+            buffer.append(std::string_view(value));
+        }
+    }
+
+    template <const auto &Template, typename... Args, std::size_t... I>
+    void write(std::string &buffer, std::index_sequence<I...>, const Args &...args)
+    {
+        static_assert((isSlotValue<Args>(Template.slotType(I)) && ...), "A slot value doesn't match its slot type");
+
+        ((buffer.append(Template.chunk(I)), writeSlot<Template.slotType(I)>(buffer, args)), ...);
+        buffer.append(Template.chunk(sizeof...(Args)));
+    }
+}
+
+// Appends `Template` to `buffer` with its slots filled by `args`, in order.
+// The number and types of `args` are checked at compile time.
+template <const auto &Template, typename... Args>
+void writeQuery(std::string &buffer, const Args &...args)
+{
+    static_assert(Template.isBalanced(), "The GraphQL template has unbalanced brackets or quotes");
+    static_assert(Template.slotCount() == sizeof...(Args), "Wrong number of slot values for the GraphQL template");
+
+    const std::size_t size = buffer.size() + Template.fixedSize() + (std::size_t{0} + ... + QueryTemplateDetail::slotSize(args));
+    if (buffer.capacity() < size)
+        buffer.reserve(std::max(size, 2 * buffer.capacity()));
+
+    QueryTemplateDetail::write<Template>(buffer, std::index_sequence_for<Args...>{}, args...);
+}
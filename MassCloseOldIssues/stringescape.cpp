@@ -0,0 +1,155 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include "stringescape.h"
+
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define STRINGESCAPE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+    bool needsEscape(const unsigned char ch)
+    {
+        return (ch < 0x20) || (ch == '"') || (ch == '\\');
+    }
+
+#if defined(__AVX2__) || defined(STRINGESCAPE_SSE2)
+    // `mask` must not be 0
+    std::size_t firstSetBit(const unsigned mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index = 0;
+        _BitScanForward(&index, mask);
+        return index;
+#else
+        return static_cast<std::size_t>(__builtin_ctz(mask));
+#endif
+    }
+#endif
+
+    // Returns the position of the first character to escape at or after `pos`, or text.size()
+    std::size_t findEscape(std::string_view text, std::size_t pos)
+    {
+        const char *data = text.data();
+        const std::size_t size = text.size();
+
+#if defined(__AVX2__)
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i lastControl = _mm256_set1_epi8(0x1F);
+
+        for (; (pos + 32) <= size; pos += 32) {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+            // An unsigned ch <= 0x1F is the only case where max(ch, 0x1F) == 0x1F
+            const __m256i control = _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, lastControl), lastControl);
+            const __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                                                    _mm256_cmpeq_epi8(chunk, backslash)),
+                                                    control);
+            const unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(special));
+            if (mask != 0)
+                return pos + firstSetBit(mask);
+        }
+#elif defined(STRINGESCAPE_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i lastControl = _mm_set1_epi8(0x1F);
+
+        for (; (pos + 16) <= size; pos += 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+            // An unsigned ch <= 0x1F is the only case where max(ch, 0x1F) == 0x1F
+            const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl);
+            const __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                              _mm_cmpeq_epi8(chunk, backslash)),
+                                                 control);
+            const unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+            if (mask != 0)
+                return pos + firstSetBit(mask);
+        }
+#endif
+
+        for (; pos < size; ++pos) {
+            if (needsEscape(static_cast<unsigned char>(data[pos])))
+                return pos;
+        }
+
+        return size;
+    }
+
+    void appendEscapedChar(std::string &buffer, const char ch)
+    {
+        switch (ch) {
+        case '"':
+            buffer.append("\\\"");
+            break;
+        case '\\':
+            buffer.append("\\\\");
+            break;
+        case '\b':
+            buffer.append("\\b");
+            break;
+        case '\f':
+            buffer.append("\\f");
+            break;
+        case '\n':
+            buffer.append("\\n");
+            break;
+        case '\r':
+            buffer.append("\\r");
+            break;
+        case '\t':
+            buffer.append("\\t");
+            break;
+        default: {
+            const auto code = static_cast<unsigned char>(ch);
+            const char escape[] = {'\\', 'u', '0', '0', HEX_DIGITS[code >> 4], HEX_DIGITS[code & 0xF]};
+            buffer.append(escape, sizeof(escape));
+            break;
+        }
+        }
+    }
+}
+
+void appendEscaped(std::string &buffer, std::string_view text)
+{
+    std::size_t pos = 0;
+    while (pos < text.size()) {
+        const std::size_t escapePos = findEscape(text, pos);
+        buffer.append(text.data() + pos, escapePos - pos);
+        if (escapePos == text.size())
+            break;
+
+        appendEscapedChar(buffer, text[escapePos]);
+        pos = escapePos + 1;
+    }
+}
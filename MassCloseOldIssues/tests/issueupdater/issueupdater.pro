@@ -0,0 +1,31 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# The network is replaced by FakeServer
+TARGET = tst_issueupdater
+
+DEFINES += BOOST_BEAST_USE_STD_STRING_VIEW
+
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/boost_1_74_0)
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+LIBS += $$quote(-LG:/QBITTORRENT/boost_1_74_0/stage/lib)
+LIBS += $$quote(-LG:/QBITTORRENT/install_mingw/base/lib)
+
+LIBS += -lssl -lcrypto -lz -lgdi32 -luser32 -lws2_32 -ladvapi32 -lcrypt32
+
+INCLUDEPATH += ../..
+
+HEADERS += fakeserver.h
+
+SOURCES += tst_issueupdater.cpp \
+           fakepostdownloader.cpp \
+           ../../batchsizer.cpp \
+           ../../graphqlrequest.cpp \
+           ../../issueupdater.cpp \
+           ../../labeltable.cpp \
+           ../../mutationqueue.cpp \
+           ../../mutationresult.cpp \
+           ../../stringescape.cpp
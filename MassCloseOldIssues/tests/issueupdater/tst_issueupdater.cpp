@@ -0,0 +1,264 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <chrono>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "fakeserver.h"
+#include "issueattributes.h"
+#include "issueupdater.h"
+#include "postdownloader.h"
+#include "programoptions.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    constexpr int ISSUES = 3;
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    ProgramOptions closeOptions()
+    {
+        ProgramOptions options{};
+        options.cutoffTimePoint = std::chrono::floor<std::chrono::milliseconds>(std::chrono::system_clock::now());
+        options.shards = 1;
+        return options;
+    }
+
+    std::vector<IssueAttributes> makeIssues()
+    {
+        std::vector<IssueAttributes> issues;
+        for (int i = 0; i < ISSUES; ++i)
+            issues.emplace_back("ISSUE_" + std::to_string(i));
+
+        return issues;
+    }
+
+    bool isMutation(std::string_view request)
+    {
+        return json::parse(request)["query"].get<std::string>().rfind("mutation", 0) == 0;
+    }
+
+    std::vector<std::string> mutations()
+    {
+        std::vector<std::string> requests;
+        for (const std::string &request : FakeServer::instance().requests) {
+            if (isMutation(request))
+                requests.push_back(request);
+        }
+
+        return requests;
+    }
+
+    // The issues are unchanged since they were gathered and every mutation succeeds
+    FakeReply answer(std::string_view request)
+    {
+        const json body = json::parse(request);
+        json data = json::object();
+
+        if (!isMutation(request)) {
+            data["nodes"] = json::array();
+            for (const auto &id : body["variables"]["ids"])
+                data["nodes"].push_back({{"id", id}, {"state", "OPEN"}, {"updatedAt", "2000-01-01T00:00:00Z"}});
+        }
+        else {
+            static const std::regex alias{R"((\w+): \w+\(input)"};
+            const std::string query = body["query"].get<std::string>();
+            for (std::sregex_iterator iter{query.cbegin(), query.cend(), alias}, end; iter != end; ++iter)
+                data[(*iter)[1].str()] = {{"clientMutationId", nullptr}};
+        }
+
+        return {{}, boost::beast::http::status::ok, json{{"data", data}}.dump()};
+    }
+
+    // The first mutation request fails with `failure` and the rest are answered
+    void failFirstMutation(const FakeReply &failure)
+    {
+        FakeServer::instance().reset();
+        FakeServer::instance().respond = [failure, failed = false](std::string_view request) mutable
+        {
+            if (failed || !isMutation(request))
+                return answer(request);
+
+            failed = true;
+            return failure;
+        };
+    }
+
+    std::string runUpdater(const ProgramOptions &options, const std::vector<IssueAttributes> &issues)
+    {
+        std::string error;
+        PostDownloader downloader{options};
+        IssueUpdater updater{options, downloader, issues, error};
+        updater.run();
+        return error;
+    }
+
+    void testTimeoutResendsRepeatableBatch()
+    {
+        const ProgramOptions options = closeOptions();
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation({"Failed read: The socket was closed due to a timeout", {}, {}});
+
+        const std::string error = runUpdater(options, issues);
+        const std::vector<std::string> sent = mutations();
+
+        check(error.empty(), "a timed out batch of closes is retried, got: " + error);
+        check(sent.size() == 2, "the timed out batch is sent again");
+        check(FakeServer::instance().newConnections == 1, "the batch is sent again on a new connection");
+        for (const IssueAttributes &issue : issues)
+            check((sent.size() == 2) && (sent[1].find(issue.ID) != std::string::npos), issue.ID + " is in the resent batch");
+    }
+
+    void testTimeoutStopsBatchWithComment()
+    {
+        ProgramOptions options = closeOptions();
+        options.comment = "Closing as stale";
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation({"Failed read: The socket was closed due to a timeout", {}, {}});
+
+        const std::string error = runUpdater(options, issues);
+
+        check(!error.empty(), "a timed out batch with comments is reported");
+        check(mutations().size() == 1, "a timed out batch with comments isn't sent again");
+    }
+
+    void testGatewayTimeoutResendsRepeatableBatch()
+    {
+        const ProgramOptions options = closeOptions();
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation({{}, boost::beast::http::status::gateway_timeout, {}});
+
+        const std::string error = runUpdater(options, issues);
+
+        check(error.empty(), "a batch of closes answered with 504 is retried, got: " + error);
+        check(mutations().size() == 2, "the batch answered with 504 is sent again");
+    }
+
+    // What GitHub answers when a query runs out of time
+    const json TIMEOUT_ERROR = {{"message", "Something went wrong while executing your query. This may be the result of a timeout, "
+                                            "or it could be a GitHub bug. Please include `0400:3E5B:1A2B3C:4D5E6F:5F4E3D2C` when reporting this issue."}};
+
+    FakeReply graphQLError(const json &error)
+    {
+        return {{}, boost::beast::http::status::ok, json{{"errors", json::array({error})}}.dump()};
+    }
+
+    void testQueryTimeoutStopsBatchWithComment()
+    {
+        ProgramOptions options = closeOptions();
+        options.comment = "Closing as stale";
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation(graphQLError(TIMEOUT_ERROR));
+
+        const std::string error = runUpdater(options, issues);
+
+        check(!error.empty(), "a batch with comments whose query timed out is reported");
+        check(mutations().size() == 1, "a batch with comments whose query timed out isn't sent again");
+    }
+
+    void testQueryTimeoutResendsRepeatableBatch()
+    {
+        const ProgramOptions options = closeOptions();
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation(graphQLError(TIMEOUT_ERROR));
+
+        const std::string error = runUpdater(options, issues);
+
+        check(error.empty(), "a batch of closes whose query timed out is retried, got: " + error);
+        check(mutations().size() == 2, "the batch of closes whose query timed out is sent again");
+    }
+
+    void testExpensiveBatchWithCommentIsResent()
+    {
+        ProgramOptions options = closeOptions();
+        options.comment = "Closing as stale";
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation(graphQLError({{"type", "MAX_NODE_LIMIT_EXCEEDED"}, {"message", "This query requests too many nodes"}}));
+
+        const std::string error = runUpdater(options, issues);
+
+        check(error.empty(), "a rejected batch with comments is retried, got: " + error);
+        check(mutations().size() == 2, "a rejected batch with comments is sent again");
+    }
+
+    void testComplexBatchIsResent()
+    {
+        const ProgramOptions options = closeOptions();
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation(graphQLError({{"message", "Query has complexity of 12000, which exceeds max complexity of 10000"}}));
+
+        const std::string error = runUpdater(options, issues);
+
+        check(error.empty(), "a batch over the max complexity is retried, got: " + error);
+        check(mutations().size() == 2, "a batch over the max complexity is sent again");
+    }
+
+    // Only the type and the start of the message classify an error, not the words in it
+    void testOtherErrorIsReported()
+    {
+        const ProgramOptions options = closeOptions();
+        const std::vector<IssueAttributes> issues = makeIssues();
+        failFirstMutation(graphQLError({{"type", "FORBIDDEN"}, {"path", {"timeout0"}},
+                                        {"message", "Resource not accessible: timeout, complexity, MAX_NODE_LIMIT_EXCEEDED"}}));
+
+        const std::string error = runUpdater(options, issues);
+
+        check(!error.empty(), "a batch with another error is reported");
+        check(mutations().size() == 1, "a batch with another error isn't sent again");
+    }
+}
+
+int main()
+{
+    testTimeoutResendsRepeatableBatch();
+    testTimeoutStopsBatchWithComment();
+    testGatewayTimeoutResendsRepeatableBatch();
+    testQueryTimeoutStopsBatchWithComment();
+    testQueryTimeoutResendsRepeatableBatch();
+    testExpensiveBatchWithCommentIsResent();
+    testComplexBatchIsResent();
+    testOtherErrorIsReported();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
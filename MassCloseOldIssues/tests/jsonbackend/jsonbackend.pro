@@ -0,0 +1,20 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks that parseJson() gives the events of json::sax_parse() and times both
+TARGET = tst_jsonbackend
+
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+LIBS += $$quote(-LG:/QBITTORRENT/install_mingw/base/lib)
+
+simdjson {
+    DEFINES += USE_SIMDJSON
+    LIBS += -lsimdjson
+}
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_jsonbackend.cpp
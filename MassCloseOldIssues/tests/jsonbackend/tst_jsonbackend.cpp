@@ -0,0 +1,231 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "jsonbackend.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    // Shaped like the responses of the issue, search, label and mutation queries.
+    // They were written by hand, not recorded, and cover escapes, nulls and number edge cases.
+    const std::vector<std::string_view> PAGES = {
+        R"({"data":{"rateLimit":{"limit":5000,"remaining":4987,"resetAt":"2020-03-06T13:00:00Z"},"repository":{"issues":{"nodes":[)"
+        R"({"id":"MDU6SXNzdWU1NzY4OTk0NDA=","createdAt":"2016-03-06T12:00:00Z","updatedAt":"2017-01-02T03:04:05Z","labels":{"totalCount":3,"nodes":[)"
+        R"({"id":"MDU6TGFiZWwxMjM0NTY3OA==","name":"Needs \"triage\""},{"id":"MDU6TGFiZWwxMjM0NTY3OQ==","name":"Caf\u00e9 \ud83d\ude00 \u2713"}]}},)"
+        R"({"id":"MDU6SXNzdWU1NzY4OTk0NDE=","createdAt":"2016-03-07T12:00:00Z","updatedAt":"2016-03-07T12:00:00Z","labels":{"totalCount":0,"nodes":[]}}],)"
+        R"("pageInfo":{"endCursor":"Y3Vyc29yOnYyOpK5MjAxNi0wMy0wN1QxMjowMDowMFo=","hasNextPage":true}}}}})",
+
+        R"({"data":{"search":{"issueCount":1234,"nodes":[{"id":"MDU6SXNzdWUx","createdAt":"2015-01-01T00:00:00Z","updatedAt":"2015-06-01T00:00:00Z"},{}],)"
+        R"("pageInfo":{"endCursor":null,"hasNextPage":false}}}})",
+
+        R"({"data":{"repository":{"id":"MDEwOlJlcG9zaXRvcnkx","labels":{"nodes":[{"id":"MDU6TGFiZWwx","name":"bug"},)"
+        R"({"id":"MDU6TGFiZWwy","name":"back\\slash \/ tab\t newline\n"}],"pageInfo":{"endCursor":"MTAw","hasNextPage":false}}}}})",
+
+        R"({"data":{"comment0":{"clientMutationId":null},"close0":{"clientMutationId":null},"lock0":null},)"
+        R"("errors":[{"type":"FORBIDDEN","path":["lock0"],"locations":[{"line":1,"column":312}],"message":"Resource not accessible by integration"}]})",
+
+        R"({"errors":[{"message":"timeout","type":"timeout"}],"data":null})",
+
+        R"([0,-1,1,9223372036854775807,-9223372036854775808,18446744073709551615,123456789012345678901234567890,)"
+        R"(1e3,-0.5,2.5E-3,true,false,null,"",[],{},[[{"":[null]}]]])",
+
+        "  {\"padded\" : [ 1 , 2 ]\n}\r\n",
+    };
+
+    const std::vector<std::string_view> INVALID_PAGES = {
+        "", "[01]", "[1.]", "[-]", "{\"a\":tru}", "{\"a\":nul}", "{} x", "{\"a\":1", "[\"\\x\"]", "[1,]", "{\"a\" 1}",
+    };
+
+    // Writes each event as a line, so two parses compare as strings
+    class EventLog
+    {
+    public:
+        bool null() { return add("null"); }
+        bool boolean(bool value) { return add(value ? "true" : "false"); }
+        // The backends disagree on which integers are unsigned, the consumers read both alike
+        bool number_integer(json::number_integer_t value) { return add("integer " + std::to_string(value)); }
+        bool number_unsigned(json::number_unsigned_t value) { return add("integer " + std::to_string(value)); }
+        bool number_float(json::number_float_t value, const std::string &)
+        {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.17g", value);
+            return add(std::string("float ") + text);
+        }
+        bool string(std::string &value) { return add("string " + value); }
+        bool start_object(std::size_t) { return add("{"); }
+        bool key(std::string &value) { return add("key " + value); }
+        bool end_object() { return add("}"); }
+        bool start_array(std::size_t) { return add("["); }
+        bool end_array() { return add("]"); }
+
+        const std::string &text() const { return m_text; }
+
+    private:
+        bool add(const std::string &event)
+        {
+            m_text += event;
+            m_text += '\n';
+            return true;
+        }
+
+        std::string m_text;
+    };
+
+    // Takes the events without doing anything, so only the parsing is timed
+    struct NullSax {
+        std::size_t events = 0;
+
+        bool null() { return ++events; }
+        bool boolean(bool) { return ++events; }
+        bool number_integer(json::number_integer_t) { return ++events; }
+        bool number_unsigned(json::number_unsigned_t) { return ++events; }
+        bool number_float(json::number_float_t, const std::string &) { return ++events; }
+        bool string(std::string &) { return ++events; }
+        bool start_object(std::size_t) { return ++events; }
+        bool key(std::string &) { return ++events; }
+        bool end_object() { return ++events; }
+        bool start_array(std::size_t) { return ++events; }
+        bool end_array() { return ++events; }
+    };
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    // What parseJson() does without USE_SIMDJSON
+    template <typename Sax>
+    bool parseWithNlohmann(std::string_view document, Sax &sax, std::string &error)
+    {
+        JsonBackendDetail::ErrorCapture<Sax> capture(sax, error);
+        return json::sax_parse(document.begin(), document.end(), &capture);
+    }
+
+    void testSameEvents()
+    {
+        for (const std::string_view page : PAGES) {
+            EventLog expected;
+            EventLog actual;
+            std::string expectedError;
+            std::string actualError;
+
+            check(parseWithNlohmann(page, expected, expectedError), "nlohmann::json parses: " + std::string(page));
+            check(parseJson(page, actual, actualError), "parseJson() parses: " + std::string(page) + " error: " + actualError);
+            check(actual.text() == expected.text(), "parseJson() gives the events of nlohmann::json for: " + std::string(page)
+                  + "\nexpected:\n" + expected.text() + "actual:\n" + actual.text());
+        }
+    }
+
+    void testSameErrors()
+    {
+        for (const std::string_view page : INVALID_PAGES) {
+            EventLog log;
+            std::string error;
+            check(!parseWithNlohmann(page, log, error), "nlohmann::json rejects: " + std::string(page));
+
+            error.clear();
+            check(!parseJson(page, log, error) && !error.empty(), "parseJson() rejects: " + std::string(page));
+        }
+    }
+
+    // A full page of 100 issues, like the ones IssueGatherer reads
+    std::string makeIssuePage()
+    {
+        std::string page = R"({"data":{"repository":{"issues":{"nodes":[)";
+        for (int i = 0; i < 100; ++i) {
+            if (i > 0)
+                page += ',';
+            page += R"({"id":"MDU6SXNzdWU1NzY4OTk)" + std::to_string(100000 + i) + R"(=","createdAt":"2016-03-06T12:00:00Z",)"
+                    R"("updatedAt":"2017-01-02T03:04:05Z","labels":{"totalCount":2,"nodes":[)"
+                    R"({"id":"MDU6TGFiZWwxMjM0NTY3OA==","name":"bug"},{"id":"MDU6TGFiZWwxMjM0NTY3OQ==","name":"needs triage"}]}})";
+        }
+        page += R"(],"pageInfo":{"endCursor":"Y3Vyc29yOnYyOpK5MjAxNi0wMy0wN1QxMjowMDowMFo=","hasNextPage":true}}}}})";
+        return page;
+    }
+
+    template <typename Parse>
+    double megabytesPerSecond(const std::string &page, Parse parse)
+    {
+        constexpr int ROUNDS = 2000;
+        NullSax sax;
+        std::string error;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ROUNDS; ++i)
+            parse(page, sax, error);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        return (static_cast<double>(page.size()) * ROUNDS) / (1024 * 1024) / elapsed.count();
+    }
+
+    void printSpeed()
+    {
+        const std::string page = makeIssuePage();
+        const double nlohmannSpeed = megabytesPerSecond(page, [](std::string_view document, NullSax &sax, std::string &error)
+        {
+            return parseWithNlohmann(document, sax, error);
+        });
+        const double backendSpeed = megabytesPerSecond(page, [](std::string_view document, NullSax &sax, std::string &error)
+        {
+            return parseJson(document, sax, error);
+        });
+
+#ifdef USE_SIMDJSON
+        const char *backend = "simdjson";
+#else
+        const char *backend = "nlohmann::json";
+#endif
+        std::cout << "Page of " << page.size() << " bytes. nlohmann::json: " << nlohmannSpeed << " MB/s, parseJson() with "
+                  << backend << ": " << backendSpeed << " MB/s" << std::endl;
+    }
+}
+
+int main()
+{
+    testSameEvents();
+    testSameErrors();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    printSpeed();
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
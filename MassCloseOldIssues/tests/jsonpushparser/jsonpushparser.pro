@@ -0,0 +1,14 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks that JsonPushParser and ConnectionStream give the results of
+# json::sax_parse() and readConnection() however the responses are split
+TARGET = tst_jsonpushparser
+
+QMAKE_CXXFLAGS_RELEASE += $$quote(-isystemG:/QBITTORRENT/install_mingw/base/include)
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_jsonpushparser.cpp
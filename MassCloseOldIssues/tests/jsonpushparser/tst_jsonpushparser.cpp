@@ -0,0 +1,384 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "connectionreader.h"
+#include "jsonpushparser.h"
+
+using json = nlohmann::json;
+using namespace std::literals;
+
+namespace
+{
+    // Shaped like the responses of the issue, search, label and mutation queries.
+    // They were written by hand, not recorded, and cover escapes, nulls and number edge cases.
+    const std::vector<std::string_view> DOCUMENTS = {
+        R"({"data":{"rateLimit":{"limit":5000,"remaining":4987,"resetAt":"2020-03-06T13:00:00Z"},"repository":{"issues":{"nodes":[)"
+        R"({"id":"MDU6SXNzdWU1NzY4OTk0NDA=","createdAt":"2016-03-06T12:00:00Z","updatedAt":"2017-01-02T03:04:05Z","labels":{"totalCount":3,"nodes":[)"
+        R"({"id":"MDU6TGFiZWwxMjM0NTY3OA==","name":"Needs \"triage\""},{"id":"MDU6TGFiZWwxMjM0NTY3OQ==","name":"Caf\u00e9 \ud83d\ude00 \u2713"}]}},)"
+        R"({"id":"MDU6SXNzdWU1NzY4OTk0NDE=","createdAt":"2016-03-07T12:00:00Z","updatedAt":"2016-03-07T12:00:00Z","labels":{"totalCount":0,"nodes":[]}}],)"
+        R"("pageInfo":{"endCursor":"Y3Vyc29yOnYyOpK5MjAxNi0wMy0wN1QxMjowMDowMFo=","hasNextPage":true}}}}})",
+
+        R"({"data":{"search":{"issueCount":1234,"nodes":[{"id":"MDU6SXNzdWUx","createdAt":"2015-01-01T00:00:00Z","updatedAt":"2015-06-01T00:00:00Z"},{}],)"
+        R"("pageInfo":{"endCursor":null,"hasNextPage":false}}}})",
+
+        R"({"data":{"repository":{"id":"MDEwOlJlcG9zaXRvcnkx","labels":{"nodes":[{"id":"MDU6TGFiZWwx","name":"bug"},)"
+        R"({"id":"MDU6TGFiZWwy","name":"back\\slash \/ tab\t newline\n \b\f\r \u0000 \u001F \u00FF \uFFFF"}],"pageInfo":{"endCursor":"MTAw","hasNextPage":false}}}}})",
+
+        R"({"data":{"comment0":{"clientMutationId":null},"close0":{"clientMutationId":null},"lock0":null},)"
+        R"("errors":[{"type":"FORBIDDEN","path":["lock0"],"locations":[{"line":1,"column":312}],"message":"Resource not accessible by integration"}]})",
+
+        R"({"errors":[{"message":"timeout","type":"timeout"}],"data":null})",
+
+        R"([0,-0,-1,1,9223372036854775807,-9223372036854775808,18446744073709551615,18446744073709551616,-9223372036854775809,)"
+        R"(123456789012345678901234567890,1e3,1E+3,1e-3,-0.5,2.5E-3,0.0,true,false,null,"",[],{},[[{"":[null]}]]])",
+
+        "  {\"padded\" : [ 1 , 2 ]\n}\r\n",
+        "\"Na\xC3\xAFve \xE2\x9C\x93 \xF0\x9F\x98\x80\"",
+        "42",
+        "-7",
+        "true",
+        "null",
+    };
+
+    const std::vector<std::string_view> INVALID_DOCUMENTS = {
+        "", " ", "[01]", "[-01]", "[1.]", "[.5]", "[-]", "[1e]", "[1e+]", "[+1]", "[0x1]", "[1,]", "[,1]", "[1 2]",
+        "{\"a\":tru}", "{\"a\":nul}", "{\"a\":truex}", "{\"a\":nulll}", "{\"a\":True}", "{} x", "{}{}", "{\"a\":1", "{\"a\" 1}",
+        "{\"a\":1,}", "{,}", "{1:2}", "{\"a\"}", "[}", "{]", "]", "}", "[\"a\"", "\"abc",
+        "[\"\\x\"]", "[\"\\u12\"]", "[\"\\u12G4\"]", "[\"\\", "[\"\\u00",
+        "[\"\\ud83d\"]", "[\"\\ud83dx\"]", "[\"\\ud83d\\n\"]", "[\"\\ude00\"]", "[\"\\ud83d\\ud83d\"]",
+        "[\"tab\there\"]", "[\"new\nline\"]", "[\"nul\0\"]"sv,
+        "[\"\x80\"]", "[\"\xC3\"]", "[\"\xC3\x28\"]", "[\"\xC0\xAF\"]", "[\"\xE0\x80\xAF\"]", "[\"\xED\xA0\x80\"]",
+        "[\"\xF4\x90\x80\x80\"]", "[\"\xF8\x88\x80\x80\x80\"]", "[\"\xFF\"]",
+    };
+
+    // Writes each event as a line, so two parses compare as strings. Returns false after `limit` events.
+    class EventLog
+    {
+    public:
+        explicit EventLog(std::size_t limit = std::string::npos)
+            : m_limit(limit)
+        {
+        }
+
+        bool null() { return add("null"); }
+        bool boolean(bool value) { return add(value ? "true" : "false"); }
+        bool number_integer(json::number_integer_t value) { return add("integer " + std::to_string(value)); }
+        bool number_unsigned(json::number_unsigned_t value) { return add("unsigned " + std::to_string(value)); }
+        bool number_float(json::number_float_t value, const std::string &text)
+        {
+            char number[32];
+            std::snprintf(number, sizeof(number), "%.17g", value);
+            return add(std::string("float ") + number + " " + text);
+        }
+        bool string(std::string &value) { return add("string " + value); }
+        bool start_object(std::size_t) { return add("{"); }
+        bool key(std::string &value) { return add("key " + value); }
+        bool end_object() { return add("}"); }
+        bool start_array(std::size_t) { return add("["); }
+        bool end_array() { return add("]"); }
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) { return false; }
+
+        const std::string &text() const { return m_text; }
+
+    private:
+        bool add(const std::string &event)
+        {
+            m_text += event;
+            m_text += '\n';
+            return ++m_events < m_limit;
+        }
+
+        std::string m_text;
+        std::size_t m_events = 0;
+        const std::size_t m_limit;
+    };
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    std::string printable(std::string_view text)
+    {
+        std::string result;
+        for (const char c : text) {
+            const auto uc = static_cast<unsigned char>(c);
+            if ((uc < 0x20) || (uc >= 0x7F)) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\x%02X", uc);
+                result += escaped;
+            }
+            else {
+                result += c;
+            }
+        }
+
+        return result;
+    }
+
+    // Feeds `document` in chunks whose sizes are given by `nextSize`. Returns the result of finish().
+    template <typename NextSize>
+    bool pushParse(std::string_view document, EventLog &log, std::string &error, NextSize nextSize)
+    {
+        JsonPushParser<EventLog> parser(log);
+        bool isParsing = true;
+        for (std::size_t pos = 0; isParsing && (pos < document.size()); ) {
+            const std::size_t size = std::min(nextSize(), document.size() - pos);
+            isParsing = parser.feed(document.substr(pos, size));
+            pos += size;
+        }
+
+        const bool isParsed = isParsing && parser.finish();
+        error = parser.error();
+        return isParsed;
+    }
+
+    // Splits the documents in every way that matters to the parser: one chunk, single bytes and random sizes
+    template <typename Test>
+    void forEachSplit(Test test)
+    {
+        std::mt19937 random(12345);
+        std::uniform_int_distribution<std::size_t> sizes(1, 16);
+
+        test("one chunk", [] { return std::string_view::npos; });
+        test("single bytes", [] { return std::size_t(1); });
+        for (int round = 0; round < 20; ++round)
+            test("random chunks", [&] { return sizes(random); });
+    }
+
+    void testSameEvents()
+    {
+        for (const std::string_view document : DOCUMENTS) {
+            EventLog expected;
+            check(json::sax_parse(document.begin(), document.end(), &expected), "nlohmann::json parses: " + printable(document));
+
+            forEachSplit([&](const std::string &split, auto nextSize)
+            {
+                EventLog actual;
+                std::string error;
+                check(pushParse(document, actual, error, nextSize), "JsonPushParser parses in " + split + ": " + printable(document)
+                      + " error: " + error);
+                check(actual.text() == expected.text(), "JsonPushParser gives the events of nlohmann::json in " + split + " for: "
+                      + printable(document) + "\nexpected:\n" + printable(expected.text()) + "\nactual:\n" + printable(actual.text()));
+            });
+        }
+    }
+
+    void testSameErrors()
+    {
+        for (const std::string_view document : INVALID_DOCUMENTS) {
+            check(!json::accept(document.begin(), document.end()), "nlohmann::json rejects: " + printable(document));
+
+            forEachSplit([&](const std::string &split, auto nextSize)
+            {
+                EventLog log;
+                std::string error;
+                check(!pushParse(document, log, error, nextSize) && !error.empty(),
+                      "JsonPushParser rejects in " + split + ": " + printable(document));
+            });
+        }
+    }
+
+    // The handler stops the parsing at every event. What came before must be the same.
+    void testStop()
+    {
+        const std::string_view document = DOCUMENTS.front();
+        EventLog all;
+        json::sax_parse(document.begin(), document.end(), &all);
+        const auto eventCount = static_cast<std::size_t>(std::count(all.text().cbegin(), all.text().cend(), '\n'));
+
+        for (std::size_t limit = 1; limit <= eventCount; ++limit) {
+            EventLog expected(limit);
+            json::sax_parse(document.begin(), document.end(), &expected);
+
+            forEachSplit([&](const std::string &split, auto nextSize)
+            {
+                EventLog actual(limit);
+                std::string error;
+                const bool isParsed = pushParse(document, actual, error, nextSize);
+                check(!isParsed && error.empty() && (actual.text() == expected.text()),
+                      "JsonPushParser stops after " + std::to_string(limit) + " events in " + split);
+            });
+        }
+    }
+
+    // The fields of an issue, like the ones IssueGatherer reads
+    struct IssueNode {
+        std::string id;
+        std::string createdAt;
+        long long labelCount = -1;
+        std::vector<std::string> labelIDs;
+        std::vector<std::string> labelNames;
+
+        void set(const FieldPath &path, std::string &value)
+        {
+            if (path.is({"id"}))
+                id = std::move(value);
+            else if (path.is({"createdAt"}))
+                createdAt = std::move(value);
+            else if (path.is({"labels", "nodes", "id"}))
+                labelIDs.push_back(std::move(value));
+            else if (path.is({"labels", "nodes", "name"}))
+                labelNames.push_back(std::move(value));
+        }
+
+        void set(const FieldPath &path, long long value)
+        {
+            if (path.is({"labels", "totalCount"}))
+                labelCount = value;
+        }
+
+        std::string text() const
+        {
+            std::string result = id + " " + createdAt + " " + std::to_string(labelCount);
+            for (std::vector<std::string>::size_type i = 0; i < labelIDs.size(); ++i)
+                result += " " + labelIDs[i] + "=" + ((i < labelNames.size()) ? labelNames[i] : "?");
+            return result;
+        }
+    };
+
+    struct Page {
+        std::string_view response;
+        std::vector<std::string_view> path;
+    };
+
+    // The connection and its nodes as text, so two readings compare as strings
+    std::string describe(const Connection<IssueNode> &connection, const std::vector<std::string> &nodes)
+    {
+        std::string result = "cursor " + connection.pageInfo.cursor + " hasNext " + std::to_string(connection.pageInfo.hasNext)
+                + " parent " + connection.parentID + " count " + std::to_string(connection.count)
+                + " found " + std::to_string(connection.isFound) + " errors " + std::to_string(connection.hasErrors)
+                + " stopped " + std::to_string(connection.isStopped) + "\n";
+        for (const std::string &node : nodes)
+            result += node + "\n";
+        return result;
+    }
+
+    // Reads `page` like IssueGatherer, with the cutoff after `maxNodes` nodes
+    std::string readWhole(const Page &page, std::size_t maxNodes)
+    {
+        std::vector<std::string> nodes;
+        const Connection<IssueNode> connection = readConnection<IssueNode>(page.response, page.path, "endCursor", "hasNextPage",
+                                                                           [&](IssueNode &node)
+        {
+            nodes.push_back(node.text());
+            return nodes.size() < maxNodes;
+        });
+
+        return describe(connection, nodes);
+    }
+
+    std::string readStream(const Page &page, std::size_t maxNodes, std::size_t split)
+    {
+        std::vector<std::string> nodes;
+        ConnectionStream<IssueNode> stream(page.path, [&](IssueNode &node)
+        {
+            nodes.push_back(node.text());
+            return nodes.size() < maxNodes;
+        });
+
+        stream.feed(page.response.substr(0, split));
+        stream.feed(page.response.substr(split));
+        return describe(stream.finish(), nodes);
+    }
+
+    void testConnectionStream()
+    {
+        const std::vector<Page> pages = {
+            {DOCUMENTS[0], {"data", "repository", "issues"}},
+            {DOCUMENTS[1], {"data", "search"}},
+            {DOCUMENTS[2], {"data", "repository", "labels"}},
+            {DOCUMENTS[4], {"data", "repository", "issues"}},
+            {R"({"data":{"repository":null}})", {"data", "repository", "issues"}},
+        };
+
+        for (const Page &page : pages) {
+            for (const std::size_t maxNodes : {std::string::npos, std::size_t(1)}) {
+                const std::string expected = readWhole(page, maxNodes);
+
+                // Every split into two chunks, including the empty ones
+                for (std::size_t split = 0; split <= page.response.size(); ++split) {
+                    std::string actual;
+                    try {
+                        actual = readStream(page, maxNodes, split);
+                    }
+                    catch (const std::exception &e) {
+                        actual = std::string("Exception: ") + e.what();
+                    }
+
+                    check(actual == expected, "ConnectionStream reads like readConnection() when split at " + std::to_string(split)
+                          + ": " + printable(page.response) + "\nexpected:\n" + expected + "actual:\n" + actual);
+                }
+            }
+        }
+    }
+
+    void testConnectionStreamErrors()
+    {
+        const std::vector<std::string_view> path = {"data", "repository", "issues"};
+        for (const std::string_view response : {R"({"data":{"repository":{"issues":{"nodes":[)", R"({"data":{"repository":{"issues":x}}})"}) {
+            bool hasThrown = false;
+            try {
+                ConnectionStream<IssueNode> stream(path, [](IssueNode &) { return true; });
+                stream.feed(response);
+                stream.finish();
+            }
+            catch (const std::exception &) {
+                hasThrown = true;
+            }
+
+            check(hasThrown, "ConnectionStream throws for: " + std::string(response));
+        }
+    }
+}
+
+int main()
+{
+    testSameEvents();
+    testSameErrors();
+    testStop();
+    testConnectionStream();
+    testConnectionStreamErrors();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
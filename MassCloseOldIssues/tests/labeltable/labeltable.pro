@@ -0,0 +1,12 @@
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle
+CONFIG -= qt
+
+# Checks the storage of LabelHandles and the interning of LabelTable
+TARGET = tst_labeltable
+
+INCLUDEPATH += ../..
+
+SOURCES += tst_labeltable.cpp \
+           ../../labeltable.cpp
@@ -0,0 +1,236 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "labeltable.h"
+
+namespace
+{
+    // LabelHandles keeps this many in place, more go to the heap
+    constexpr std::size_t INLINE_CAPACITY = 6;
+    const std::vector<std::size_t> SIZES = {0, 1, INLINE_CAPACITY - 1, INLINE_CAPACITY, INLINE_CAPACITY + 1,
+                                            2 * INLINE_CAPACITY, 2 * INLINE_CAPACITY + 1, 100};
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    LabelHandles makeHandles(const std::size_t size, const LabelHandle first = 0)
+    {
+        LabelHandles handles;
+        for (std::size_t i = 0; i < size; ++i)
+            handles.push_back(first + static_cast<LabelHandle>(i));
+        return handles;
+    }
+
+    bool isInline(const LabelHandles &handles)
+    {
+        const auto *begin = reinterpret_cast<const char *>(handles.begin());
+        const auto *object = reinterpret_cast<const char *>(&handles);
+        return (begin >= object) && (begin < (object + sizeof(handles)));
+    }
+
+    // `handles` holds first, first + 1, ... and is stored in place only when it fits
+    void checkHandles(const LabelHandles &handles, const std::size_t size, const LabelHandle first, const std::string &what)
+    {
+        const std::string prefix = what + " with " + std::to_string(size) + " handles: ";
+        check(handles.size() == size, prefix + "size() is " + std::to_string(handles.size()));
+        check((handles.end() - handles.begin()) == static_cast<std::ptrdiff_t>(handles.size()), prefix + "end() - begin() isn't size()");
+        check(isInline(handles) == (size <= INLINE_CAPACITY), prefix + (isInline(handles) ? "is in place" : "is on the heap"));
+
+        if (handles.size() != size)
+            return;
+        for (std::size_t i = 0; i < size; ++i) {
+            check(handles.begin()[i] == (first + i), prefix + "handle " + std::to_string(i) + " is "
+                  + std::to_string(handles.begin()[i]));
+        }
+    }
+
+    void testPushBack()
+    {
+        LabelHandles handles;
+        checkHandles(handles, 0, 0, "Empty");
+        for (std::size_t size = 1; size <= 100; ++size) {
+            handles.push_back(static_cast<LabelHandle>(size - 1));
+            checkHandles(handles, size, 0, "push_back()");
+        }
+    }
+
+    void testContains()
+    {
+        for (const std::size_t size : SIZES) {
+            const LabelHandles handles = makeHandles(size, 10);
+            for (std::size_t i = 0; i < size; ++i)
+                check(handles.contains(10 + static_cast<LabelHandle>(i)), "contains() misses handle " + std::to_string(i)
+                      + " of " + std::to_string(size));
+            check(!handles.contains(9), "contains() finds the handle before the first of " + std::to_string(size));
+            check(!handles.contains(10 + static_cast<LabelHandle>(size)), "contains() finds the handle after the last of "
+                  + std::to_string(size));
+            check(!handles.contains(NO_LABEL), "contains() finds NO_LABEL in " + std::to_string(size));
+        }
+    }
+
+    void testCopy()
+    {
+        for (const std::size_t size : SIZES) {
+            const LabelHandles original = makeHandles(size);
+            LabelHandles copy(original);
+            checkHandles(copy, size, 0, "Copy constructed");
+            checkHandles(original, size, 0, "Copied from");
+            if (size > 0)
+                check(copy.begin() != original.begin(), "The copy with " + std::to_string(size) + " handles shares the storage");
+
+            // The copy owns its storage
+            copy.push_back(static_cast<LabelHandle>(size));
+            checkHandles(copy, size + 1, 0, "Pushed to copy");
+            checkHandles(original, size, 0, "Copied from, after the copy grew");
+
+            // Into each size of target
+            for (const std::size_t targetSize : SIZES) {
+                LabelHandles target = makeHandles(targetSize, 1000);
+                target = original;
+                checkHandles(target, size, 0, "Copy assigned over " + std::to_string(targetSize));
+                checkHandles(original, size, 0, "Copy assigned from");
+            }
+        }
+    }
+
+    void testMove()
+    {
+        for (const std::size_t size : SIZES) {
+            LabelHandles original = makeHandles(size);
+            LabelHandles moved(std::move(original));
+            checkHandles(moved, size, 0, "Move constructed");
+            checkHandles(original, 0, 0, "Move constructed from");
+
+            // Emptied, it can be used again
+            original.push_back(7);
+            check((original.size() == 1) && original.contains(7), "Pushing to an instance that was moved from fails");
+
+            for (const std::size_t targetSize : SIZES) {
+                LabelHandles source = makeHandles(size);
+                LabelHandles target = makeHandles(targetSize, 1000);
+                target = std::move(source);
+                checkHandles(target, size, 0, "Move assigned over " + std::to_string(targetSize));
+                checkHandles(source, 0, 0, "Move assigned from");
+            }
+        }
+    }
+
+    // Moves from the heap into an instance that is in place and back
+    void testMoveBetweenStorages()
+    {
+        LabelHandles onHeap = makeHandles(2 * INLINE_CAPACITY);
+        LabelHandles inPlace = makeHandles(2, 1000);
+
+        inPlace = std::move(onHeap);
+        checkHandles(inPlace, 2 * INLINE_CAPACITY, 0, "Moved from the heap into place");
+        checkHandles(onHeap, 0, 0, "Moved to place from the heap");
+
+        onHeap = makeHandles(INLINE_CAPACITY + 3, 2000);
+        onHeap = makeHandles(3, 3000);
+        checkHandles(onHeap, 3, 3000, "Moved from place onto the heap");
+
+        onHeap = std::move(inPlace);
+        checkHandles(onHeap, 2 * INLINE_CAPACITY, 0, "Moved back");
+        checkHandles(inPlace, 0, 0, "Moved back from");
+    }
+
+    void testSelfAssignment()
+    {
+        for (const std::size_t size : SIZES) {
+            LabelHandles handles = makeHandles(size);
+            // Through a reference, because the compilers warn about the obvious self assignment
+            LabelHandles &same = handles;
+
+            handles = same;
+            checkHandles(handles, size, 0, "Copy assigned to itself");
+
+            handles = std::move(same);
+            checkHandles(handles, size, 0, "Move assigned to itself");
+        }
+    }
+
+    void testInterning()
+    {
+        LabelTable &table = LabelTable::instance();
+
+        const LabelHandle first = table.internID("LA_kwDOAbc1");
+        const LabelHandle second = table.internID("LA_kwDOAbc2");
+        const LabelHandle third = table.internID("LA_kwDOAbc3");
+        check((first == 0) && (second == 1) && (third == 2), "The ID handles aren't 0, 1, 2");
+        check(table.internID("LA_kwDOAbc2") == second, "Interning an ID again gives another handle");
+        // IDs are case sensitive
+        check(table.internID("la_kwdoabc1") == 3, "An ID that only differs in case isn't a new handle");
+        check(table.id(first) == "LA_kwDOAbc1", "id() of the first handle is \"" + std::string(table.id(first)) + "\"");
+        check(table.id(third) == "LA_kwDOAbc3", "id() of the third handle is \"" + std::string(table.id(third)) + "\"");
+
+        // The names are numbered on their own
+        const LabelHandle bug = table.internName("Bug");
+        const LabelHandle needsInfo = table.internName("Needs Info");
+        check((bug == 0) && (needsInfo == 1), "The name handles aren't 0, 1");
+        check(table.internName("bug") == bug, "\"bug\" isn't the handle of \"Bug\"");
+        check(table.internName("BUG") == bug, "\"BUG\" isn't the handle of \"Bug\"");
+        check(table.internName("needs info") == needsInfo, "\"needs info\" isn't the handle of \"Needs Info\"");
+        check(table.internName("Needs  Info") == 2, "\"Needs  Info\" isn't a new handle");
+        // Only ASCII is folded
+        check(table.internName("\xC3\x89tat") != table.internName("\xC3\xA9tat"), "Non-ASCII names are folded");
+
+        // The handles stay valid while the table grows
+        for (int i = 0; i < 10000; ++i)
+            table.internID("LA_generated" + std::to_string(i));
+        check(table.internID("LA_kwDOAbc2") == second, "The handle of an ID changed after the table grew");
+        check(table.id(second) == "LA_kwDOAbc2", "id() changed after the table grew");
+        check(table.internID("LA_generated9999") == 10003, "The handles after growing aren't dense");
+        check(table.internName("BUG") == bug, "The handle of a name changed after the table grew");
+    }
+}
+
+int main()
+{
+    testPushBack();
+    testContains();
+    testCopy();
+    testMove();
+    testMoveBetweenStorages();
+    testSelfAssignment();
+    testInterning();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
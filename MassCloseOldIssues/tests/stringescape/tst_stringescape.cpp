@@ -0,0 +1,258 @@
+/* MIT License
+
+Copyright (c) 2020 sledgehammer999 <hammered999@gmail.com>
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "stringescape.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    // The SIMD loops read 16 or 32 bytes at a time, so the lengths cover a few blocks and the tails after them
+    constexpr std::size_t MAX_LENGTH = 70;
+    // Around the ends of the first 16 and 32 byte blocks
+    const std::vector<std::size_t> BLOCK_EDGES = {15, 16, 31, 32, 33};
+    const std::vector<std::string_view> UTF8_CHARACTERS = {"\xC3\xA9", "\xE2\x9C\x93", "\xF0\x9F\x98\x80"};
+
+    int failures = 0;
+
+    void check(const bool condition, const std::string &message)
+    {
+        if (condition)
+            return;
+
+        ++failures;
+        std::cerr << "FAIL: " << message << std::endl;
+    }
+
+    std::string printable(std::string_view text)
+    {
+        std::string result;
+        for (const char c : text) {
+            const auto uc = static_cast<unsigned char>(c);
+            if ((uc < 0x20) || (uc >= 0x7F)) {
+                constexpr char HEX_DIGITS[] = "0123456789ABCDEF";
+                result += "\\x";
+                result += HEX_DIGITS[uc >> 4];
+                result += HEX_DIGITS[uc & 0xF];
+            }
+            else {
+                result += c;
+            }
+        }
+
+        return result;
+    }
+
+    // nlohmann::json escapes a string like a JSON literal, which is what GraphQL accepts too
+    void checkEscaped(const std::string &text)
+    {
+        const std::string literal = json(text).dump();
+        const std::string expected = literal.substr(1, literal.size() - 2);
+
+        std::string actual = "prefix";
+        appendEscaped(actual, text);
+        check(actual == ("prefix" + expected), "appendEscaped() of \"" + printable(text) + "\" gives \"" + printable(actual)
+              + "\" instead of \"prefix" + printable(expected) + "\"");
+    }
+
+    // Every character to escape, and 0x7F which isn't, at every position of every length
+    void testSpecialCharacters()
+    {
+        std::vector<char> specials = {'"', '\\', '\x7F'};
+        for (int c = 0; c < 0x20; ++c)
+            specials.push_back(static_cast<char>(c));
+
+        for (std::size_t length = 0; length <= MAX_LENGTH; ++length) {
+            const std::string plain(length, 'a');
+            checkEscaped(plain);
+
+            for (std::size_t pos = 0; pos < length; ++pos) {
+                for (const char special : specials) {
+                    std::string text = plain;
+                    text[pos] = special;
+                    checkEscaped(text);
+                }
+            }
+        }
+    }
+
+    // Only special characters, so every block has one at every position
+    void testOnlySpecialCharacters()
+    {
+        for (std::size_t length = 1; length <= MAX_LENGTH; ++length) {
+            std::string text;
+            for (std::size_t i = 0; i < length; ++i)
+                text += static_cast<char>((i % 3 == 0) ? '"' : ((i % 3 == 1) ? '\\' : static_cast<char>(i % 0x20)));
+            checkEscaped(text);
+        }
+    }
+
+    // The bytes of multibyte characters are 0x80 and above, which the unsigned compare must not take for controls
+    void testUtf8AtBlockEdges()
+    {
+        for (std::size_t length = 0; length <= MAX_LENGTH; ++length) {
+            for (const std::size_t pos : BLOCK_EDGES) {
+                if (pos > length)
+                    continue;
+
+                for (const std::string_view character : UTF8_CHARACTERS) {
+                    std::string text(length, 'b');
+                    text.insert(pos, character);
+                    checkEscaped(text);
+
+                    // And a character to escape right after it
+                    text.insert(pos + character.size(), 1, '"');
+                    checkEscaped(text);
+                    text[pos + character.size()] = '\n';
+                    checkEscaped(text);
+                    text[pos + character.size()] = '\x7F';
+                    checkEscaped(text);
+                }
+            }
+        }
+    }
+
+    void testPrintableAscii()
+    {
+        std::string text;
+        for (int c = 0x20; c < 0x7F; ++c)
+            text += static_cast<char>(c);
+        checkEscaped(text);
+    }
+
+    // The per-character loop that escaped the titles before appendEscaped()
+    void appendEscapedByLoop(std::string &buffer, std::string_view text)
+    {
+        for (const char ch : text) {
+            switch (ch) {
+            case '\"':
+                buffer.append("\\\"");
+                break;
+            case '\\':
+                buffer.append("\\\\");
+                break;
+            case '/':
+                buffer.append("\\/");
+                break;
+            default:
+                buffer.append(1, ch);
+                break;
+            }
+        }
+    }
+
+    // Titles of 20-100 characters, a tenth of them with a quote
+    std::vector<std::string> makeTitles()
+    {
+        std::mt19937 random(12345);
+        std::uniform_int_distribution<std::size_t> lengths(20, 100);
+        std::uniform_int_distribution<int> letters('a', 'z');
+        std::uniform_int_distribution<int> tenth(0, 9);
+
+        std::vector<std::string> titles(100000);
+        for (std::string &title : titles) {
+            title.resize(lengths(random));
+            for (char &c : title)
+                c = static_cast<char>(letters(random));
+            if (tenth(random) == 0)
+                title[title.size() / 2] = '"';
+        }
+
+        return titles;
+    }
+
+    template <typename Escape>
+    double nanosecondsPerByte(const std::vector<std::string> &texts, int rounds, Escape escape)
+    {
+        std::size_t bytes = 0;
+        std::size_t written = 0;
+        std::string buffer;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; ++round) {
+            for (const std::string &text : texts) {
+                buffer.clear();
+                escape(buffer, text);
+                bytes += text.size();
+                written += buffer.size();
+            }
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+        // Keeps the work from being optimized away
+        if (written == 0)
+            std::cout << "";
+        return elapsed.count() / static_cast<double>(bytes);
+    }
+
+    void printSpeed()
+    {
+        const std::vector<std::string> titles = makeTitles();
+        const std::vector<std::string> comment = {std::string(4096, 'c')};
+
+#if defined(__AVX2__)
+        const char *path = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        const char *path = "SSE2";
+#else
+        const char *path = "scalar";
+#endif
+        std::cout << "ns/byte           titles  comment\n"
+                  << "old loop          " << nanosecondsPerByte(titles, 5, appendEscapedByLoop) << "  "
+                  << nanosecondsPerByte(comment, 20000, appendEscapedByLoop) << "\n"
+                  << "appendEscaped() with " << path << ": " << nanosecondsPerByte(titles, 5, appendEscaped) << "  "
+                  << nanosecondsPerByte(comment, 20000, appendEscaped) << std::endl;
+    }
+}
+
+int main()
+{
+#if defined(__AVX2__) && defined(__GNUC__)
+    if (!__builtin_cpu_supports("avx2")) {
+        std::cout << "The CPU has no AVX2, skipped" << std::endl;
+        return 0;
+    }
+#endif
+
+    testSpecialCharacters();
+    testOnlySpecialCharacters();
+    testUtf8AtBlockEdges();
+    testPrintableAscii();
+
+    if (failures > 0) {
+        std::cerr << failures << " checks failed" << std::endl;
+        return 1;
+    }
+
+    printSpeed();
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
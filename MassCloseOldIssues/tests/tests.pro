@@ -0,0 +1,9 @@
+TEMPLATE = subdirs
+
+# Run with "make check". Add CONFIG+=simdjson to compare simdjson with nlohmann::json.
+SUBDIRS = issueupdater \
+          jsonbackend \
+          jsonpushparser \
+          labeltable \
+          stringescape \
+          stringescapeavx2